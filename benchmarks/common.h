@@ -0,0 +1,111 @@
+/*-----------------------------
+
+ [benchmarks/common.h]
+ - Alexander Brandt 2020
+-----------------------------*/
+
+#ifndef JA_BENCHMARKS_COMMON_H
+#define JA_BENCHMARKS_COMMON_H
+
+	#include <stdint.h>
+	#include <stdio.h>
+	#include <stdlib.h>
+	#include <time.h>
+
+	#if defined(_WIN32)
+		#define WIN32_LEAN_AND_MEAN
+		#include <windows.h>
+	#else
+		#include <pthread.h>
+		#include <unistd.h>
+	#endif
+
+	static inline double Now()
+	{
+		struct timespec t;
+		timespec_get(&t, TIME_UTC);
+
+		return (double)t.tv_sec + (double)t.tv_nsec / 1000000000.0;
+	}
+
+	static inline uint64_t Random(uint64_t* state)
+	{
+		// Xorshift64*
+		*state ^= *state >> 12;
+		*state ^= *state << 25;
+		*state ^= *state >> 27;
+		return *state * 0x2545F4914F6CDD1D;
+	}
+
+	static inline void PrintResult(const char* name, size_t operations, double seconds)
+	{
+		printf(" - %-28s %8.2f ns/op, %8.2f Mop/s\n", name, (seconds * 1000000000.0) / (double)operations,
+		       ((double)operations / seconds) / 1000000.0);
+	}
+
+	struct ThreadStart
+	{
+		void (*function)(void*);
+		void* data;
+	};
+
+	#if defined(_WIN32)
+		typedef HANDLE Thread;
+		typedef SRWLOCK Mutex;
+
+		static inline DWORD WINAPI ThreadTrampoline(LPVOID start)
+		{
+			((struct ThreadStart*)start)->function(((struct ThreadStart*)start)->data);
+			return 0;
+		}
+
+		static inline int ThreadCreate(Thread* thread, struct ThreadStart* start)
+		{
+			return ((*thread = CreateThread(NULL, 0, ThreadTrampoline, start, 0, NULL)) != NULL) ? 0 : 1;
+		}
+
+		static inline void ThreadJoin(Thread thread)
+		{
+			WaitForSingleObject(thread, INFINITE);
+			CloseHandle(thread);
+		}
+
+		static inline size_t CoresNo()
+		{
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return (size_t)info.dwNumberOfProcessors;
+		}
+
+		static inline void MutexInit(Mutex* mutex) { InitializeSRWLock(mutex); }
+		static inline void MutexLock(Mutex* mutex) { AcquireSRWLockExclusive(mutex); }
+		static inline void MutexUnlock(Mutex* mutex) { ReleaseSRWLockExclusive(mutex); }
+	#else
+		typedef pthread_t Thread;
+		typedef pthread_mutex_t Mutex;
+
+		static inline void* ThreadTrampoline(void* start)
+		{
+			((struct ThreadStart*)start)->function(((struct ThreadStart*)start)->data);
+			return NULL;
+		}
+
+		static inline int ThreadCreate(Thread* thread, struct ThreadStart* start)
+		{
+			return (pthread_create(thread, NULL, ThreadTrampoline, start) == 0) ? 0 : 1;
+		}
+
+		static inline void ThreadJoin(Thread thread) { pthread_join(thread, NULL); }
+
+		static inline size_t CoresNo()
+		{
+			long cores = sysconf(_SC_NPROCESSORS_ONLN);
+			return (cores > 0) ? (size_t)cores : 1;
+		}
+
+		static inline void MutexInit(Mutex* mutex) { pthread_mutex_init(mutex, NULL); }
+		static inline void MutexLock(Mutex* mutex) { pthread_mutex_lock(mutex); }
+		static inline void MutexUnlock(Mutex* mutex) { pthread_mutex_unlock(mutex); }
+	#endif
+
+#endif
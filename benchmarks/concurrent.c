@@ -0,0 +1,202 @@
+/*-----------------------------
+
+ [concurrent.c]
+ - Alexander Brandt 2020
+
+ Usage: bench-concurrent [keys_no]
+ Lookups from 1 to all cores, over a dictionary behind a mutex
+ and a concurrent one. Without arguments uses 1M keys.
+-----------------------------*/
+
+#include <string.h>
+
+#include "common.h"
+#include "japan-dictionary.h"
+
+
+#define KEY_LEN 32 // "temporal/" and 20 digits fit
+#define LOOKUPS_PER_THREAD 2000000
+
+enum Mode
+{
+	MODE_MUTEX,
+	MODE_CONCURRENT,
+	MODE_CONCURRENT_WRITER
+};
+
+struct Shared
+{
+	enum Mode mode;
+	struct jaDictionary* d;
+	Mutex mutex;
+
+	const char* keys;
+	size_t keys_no;
+
+	int readers_done; // Protected by the mutex, unused otherwise in this mode
+	size_t writes_no;
+};
+
+struct Reader
+{
+	struct Shared* shared;
+	uint64_t seed;
+	size_t found;
+};
+
+
+static void sReader(void* data)
+{
+	struct Reader* reader = data;
+	struct Shared* shared = reader->shared;
+	uint64_t state = reader->seed;
+
+	for (size_t i = 0; i < LOOKUPS_PER_THREAD; i++)
+	{
+		const char* key = shared->keys + (Random(&state) % shared->keys_no) * KEY_LEN;
+
+		if (shared->mode == MODE_MUTEX)
+		{
+			MutexLock(&shared->mutex);
+			reader->found += (jaDictionaryGet(shared->d, key) != NULL) ? 1 : 0;
+			MutexUnlock(&shared->mutex);
+		}
+		else
+		{
+			size_t token = jaDictionaryReadBegin(shared->d);
+			reader->found += (jaDictionaryGet(shared->d, key) != NULL) ? 1 : 0;
+			jaDictionaryReadEnd(shared->d, token);
+		}
+	}
+}
+
+
+static void sWriter(void* data)
+{
+	struct Shared* shared = data;
+	char key[KEY_LEN];
+	int done = 0;
+
+	// Adds and removes keys that readers never look for
+	while (done == 0)
+	{
+		MutexLock(&shared->mutex);
+		done = shared->readers_done;
+		MutexUnlock(&shared->mutex);
+
+		snprintf(key, KEY_LEN, "temporal/%zu", shared->writes_no % 1024);
+
+		if (jaDictionaryRemoveN(shared->d, key, strlen(key)) != 0)
+			jaDictionaryAdd(shared->d, key, NULL, 0);
+
+		shared->writes_no += 1;
+	}
+}
+
+
+static void sBenchmark(struct Shared* shared, size_t threads_no)
+{
+	Thread* threads = malloc(sizeof(Thread) * threads_no);
+	struct Reader* readers = calloc(threads_no, sizeof(struct Reader));
+	struct ThreadStart* starts = malloc(sizeof(struct ThreadStart) * threads_no);
+
+	struct ThreadStart writer_start = {sWriter, shared};
+	Thread writer;
+
+	if (threads == NULL || readers == NULL || starts == NULL)
+		goto return_failure;
+
+	shared->readers_done = 0;
+	shared->writes_no = 0;
+
+	if (shared->mode == MODE_CONCURRENT_WRITER && ThreadCreate(&writer, &writer_start) != 0)
+		goto return_failure;
+
+	double start = Now();
+
+	for (size_t i = 0; i < threads_no; i++)
+	{
+		readers[i].shared = shared;
+		readers[i].seed = 0x1234567 + i;
+		starts[i].function = sReader;
+		starts[i].data = &readers[i];
+
+		if (ThreadCreate(&threads[i], &starts[i]) != 0)
+			threads_no = i; // Measure what we have
+	}
+
+	for (size_t i = 0; i < threads_no; i++)
+		ThreadJoin(threads[i]);
+
+	double seconds = Now() - start;
+	char name[64];
+
+	MutexLock(&shared->mutex);
+	shared->readers_done = 1;
+	MutexUnlock(&shared->mutex);
+
+	if (shared->mode == MODE_CONCURRENT_WRITER)
+		ThreadJoin(writer);
+
+	snprintf(name, 64, "%zu threads", threads_no);
+	PrintResult(name, LOOKUPS_PER_THREAD * threads_no, seconds);
+
+	for (size_t i = 0; i < threads_no; i++)
+	{
+		if (readers[i].found != LOOKUPS_PER_THREAD)
+			printf(" - Error, %zu keys found of %i!\n", readers[i].found, LOOKUPS_PER_THREAD);
+	}
+
+	if (shared->mode == MODE_CONCURRENT_WRITER)
+		printf("   (%zu writes meanwhile)\n", shared->writes_no);
+
+return_failure:
+	free(threads);
+	free(readers);
+	free(starts);
+}
+
+
+int main(int argc, const char* argv[])
+{
+	struct Shared shared = {0};
+	size_t cores_no = CoresNo();
+	char* keys = NULL;
+
+	shared.keys_no = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+
+	if (shared.keys_no == 0 || (keys = malloc(shared.keys_no * KEY_LEN)) == NULL)
+	{
+		fprintf(stderr, "Can't prepare %zu keys\n", shared.keys_no);
+		return EXIT_FAILURE;
+	}
+
+	for (size_t i = 0; i < shared.keys_no; i++)
+		snprintf(keys + i * KEY_LEN, KEY_LEN, "asset/%zu", i);
+
+	shared.keys = keys;
+	MutexInit(&shared.mutex);
+
+	const char* names[] = {"Get() behind a mutex", "Concurrent Get()", "Concurrent Get(), with a writer"};
+	enum jaDictionaryFlags flags[] = {JA_DICTIONARY_OPEN_ADDRESSING, JA_DICTIONARY_CONCURRENT,
+	                                  JA_DICTIONARY_CONCURRENT};
+
+	for (int m = MODE_MUTEX; m <= MODE_CONCURRENT_WRITER; m++)
+	{
+		printf("\n%s, %zu keys:\n", names[m], shared.keys_no);
+
+		shared.mode = (enum Mode)m;
+		shared.d = jaDictionaryCreateEx(NULL, flags[m]);
+
+		for (size_t i = 0; i < shared.keys_no; i++)
+			jaDictionaryAdd(shared.d, keys + i * KEY_LEN, NULL, 0);
+
+		for (size_t threads_no = 1; threads_no < cores_no * 2; threads_no *= 2)
+			sBenchmark(&shared, (threads_no < cores_no) ? threads_no : cores_no);
+
+		jaDictionaryDelete(shared.d);
+	}
+
+	free(keys);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,211 @@
+/*-----------------------------
+
+ [dictionaries.c]
+ - Alexander Brandt 2020
+
+ Usage: bench-dictionaries [keys_no] [keys_no] ...
+ Without arguments runs with 1K, 1M and 10M keys.
+-----------------------------*/
+
+#include <string.h>
+
+#include "common.h"
+#include "japan-dictionary.h"
+
+
+#define KEY_LEN 32 // "missing/" and 20 digits fit
+#define HOT_KEYS 64 // Like a configuration, in cache
+#define HOT_LOOKUPS 4000000
+
+struct Configuration
+{
+	const char* name;
+	enum jaDictionaryFlags flags;
+};
+
+static struct Configuration configurations[] = {
+    {"Linear hashing", JA_DICTIONARY_DEFAULT},
+    {"Linear hashing (arena)", JA_DICTIONARY_ARENA},
+    {"Open addressing", JA_DICTIONARY_OPEN_ADDRESSING},
+    {"Open addressing (arena)", JA_DICTIONARY_OPEN_ADDRESSING | JA_DICTIONARY_ARENA},
+};
+
+
+static char* sGenerateKeys(size_t keys_no, const char* prefix)
+{
+	char* keys = NULL;
+
+	if ((keys = malloc(keys_no * KEY_LEN)) != NULL)
+	{
+		for (size_t i = 0; i < keys_no; i++)
+			snprintf(keys + i * KEY_LEN, KEY_LEN, "%s/%zu", prefix, i);
+	}
+
+	return keys;
+}
+
+
+static size_t* sGenerateOrder(size_t keys_no)
+{
+	size_t* order = NULL;
+	uint64_t state = 0x1234567;
+
+	if ((order = malloc(keys_no * sizeof(size_t))) != NULL)
+	{
+		for (size_t i = 0; i < keys_no; i++)
+			order[i] = i;
+
+		for (size_t i = keys_no - 1; i > 0; i--) // Fisher–Yates
+		{
+			size_t r = (size_t)(Random(&state) % (i + 1));
+			size_t temp = order[i];
+
+			order[i] = order[r];
+			order[r] = temp;
+		}
+	}
+
+	return order;
+}
+
+
+static void sIterationCallback(struct jaDictionaryItem* item, void* extra_data)
+{
+	*(size_t*)extra_data += item->key_size;
+}
+
+
+static void sBenchmark(enum jaDictionaryFlags flags, const char* keys, const char* const* keys_pointers,
+                       const char* missing_keys, const size_t* order, size_t keys_no)
+{
+	struct jaFrozenDictionary* frozen = NULL;
+	struct jaDictionaryItem* batch[64];
+	struct jaDictionaryItem* item = NULL;
+	struct jaDictionaryState state = {0};
+	struct jaDictionary* d = NULL;
+	double start = 0.0;
+	size_t found = 0;
+	size_t frozen_found = 0;
+	size_t hot_found = 0;
+	size_t sum[3] = {0};
+
+	if ((d = jaDictionaryCreateEx(NULL, flags)) == NULL)
+		return;
+
+	start = Now();
+	for (size_t i = 0; i < keys_no; i++)
+		jaDictionaryAdd(d, keys + i * KEY_LEN, NULL, 0);
+	PrintResult("Insert", keys_no, Now() - start);
+
+	start = Now();
+	for (size_t i = 0; i < keys_no; i++)
+		found += (jaDictionaryGet(d, keys + order[i] * KEY_LEN) != NULL) ? 1 : 0;
+	PrintResult("Lookup (hit)", keys_no, Now() - start);
+
+	start = Now();
+	for (size_t i = 0; i < keys_no; i++)
+		found += (jaDictionaryGet(d, missing_keys + order[i] * KEY_LEN) != NULL) ? 1 : 0;
+	PrintResult("Lookup (miss)", keys_no, Now() - start);
+
+	start = Now();
+	for (size_t i = 0; i < HOT_LOOKUPS; i++)
+		hot_found += (jaDictionaryGet(d, keys + order[i % HOT_KEYS % keys_no] * KEY_LEN) != NULL) ? 1 : 0;
+	PrintResult("Lookup (hot)", HOT_LOOKUPS, Now() - start);
+
+	start = Now();
+	jaDictionaryIterate(d, sIterationCallback, &sum[0]);
+	PrintResult("Iterate (callback)", keys_no, Now() - start);
+
+	start = Now();
+	state.start = d;
+	while ((item = jaDictionaryIterateNext(&state)) != NULL)
+		sum[1] += item->key_size;
+	PrintResult("Iterate (cursor)", keys_no, Now() - start);
+
+	start = Now();
+	state.start = d;
+	for (size_t n = 0; (n = jaDictionaryIterateBatch(&state, batch, 64)) != 0;)
+	{
+		for (size_t i = 0; i < n; i++)
+			sum[2] += batch[i]->key_size;
+	}
+	PrintResult("Iterate (batch)", keys_no, Now() - start);
+
+	start = Now();
+	frozen = jaDictionaryFreeze(d, 0);
+	PrintResult("Freeze", keys_no, Now() - start);
+
+	start = Now();
+	for (size_t i = 0; i < keys_no; i++)
+		frozen_found += (jaFrozenDictionaryGet(frozen, keys + order[i] * KEY_LEN) != NULL) ? 1 : 0;
+	PrintResult("Lookup (frozen, hit)", keys_no, Now() - start);
+
+	start = Now();
+	for (size_t i = 0; i < keys_no; i++)
+		frozen_found += (jaFrozenDictionaryGet(frozen, missing_keys + order[i] * KEY_LEN) != NULL) ? 1 : 0;
+	PrintResult("Lookup (frozen, miss)", keys_no, Now() - start);
+
+	jaFrozenDictionaryDelete(frozen);
+
+	start = Now();
+	jaDictionaryDelete(d);
+	PrintResult("Delete", keys_no, Now() - start);
+
+	// Again, at once
+	if ((d = jaDictionaryCreateEx(NULL, flags)) == NULL)
+		return;
+
+	start = Now();
+	jaDictionaryAddBatch(d, keys_no, keys_pointers, NULL, 0);
+	PrintResult("Insert (batch)", keys_no, Now() - start);
+
+	jaDictionaryDelete(d);
+
+	if (found != keys_no || frozen_found != keys_no)
+		printf(" - Error, %zu keys found of %zu!\n", (found != keys_no) ? found : frozen_found, keys_no);
+
+	if (hot_found != HOT_LOOKUPS)
+		printf(" - Error, %zu hot keys found of %u!\n", hot_found, HOT_LOOKUPS);
+
+	if (sum[0] != sum[1] || sum[0] != sum[2])
+		printf(" - Error, iterations differ!\n");
+}
+
+
+int main(int argc, const char* argv[])
+{
+	size_t default_keys_no[] = {1000, 1000000, 10000000};
+	size_t runs_no = (argc > 1) ? (size_t)(argc - 1) : 3;
+
+	for (size_t r = 0; r < runs_no; r++)
+	{
+		size_t keys_no = (argc > 1) ? strtoul(argv[r + 1], NULL, 10) : default_keys_no[r];
+
+		char* keys = sGenerateKeys(keys_no, "asset");
+		char* missing_keys = sGenerateKeys(keys_no, "missing");
+		size_t* order = sGenerateOrder(keys_no);
+		const char** keys_pointers = malloc(keys_no * sizeof(char*));
+
+		if (keys_no == 0 || keys == NULL || missing_keys == NULL || order == NULL || keys_pointers == NULL)
+		{
+			fprintf(stderr, "Can't prepare %zu keys\n", keys_no);
+			return EXIT_FAILURE;
+		}
+
+		for (size_t i = 0; i < keys_no; i++)
+			keys_pointers[i] = keys + i * KEY_LEN;
+
+		for (size_t c = 0; c < (sizeof(configurations) / sizeof(struct Configuration)); c++)
+		{
+			printf("\n%s, %zu keys:\n", configurations[c].name, keys_no);
+			sBenchmark(configurations[c].flags, keys, keys_pointers, missing_keys, order, keys_no);
+		}
+
+		free(keys_pointers);
+		free(order);
+		free(missing_keys);
+		free(keys);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/*-----------------------------
+
+ [flooding.c]
+ - Alexander Brandt 2020
+
+ Usage: bench-flooding [keys_no] [keys_no] ...
+ Keys crafted to share the low 20 bits of their FNV1 hash, so
+ all land in one bucket, against a seeded dictionary. Without
+ arguments runs with 1K, 4K and 16K keys.
+-----------------------------*/
+
+#include <string.h>
+
+#include "common.h"
+#include "japan-dictionary.h"
+
+
+#define PREFIX_LEN 32              // "flood", 20 digits and "-" fit
+#define KEY_LEN (PREFIX_LEN + 5 + 1) // Plus five characters and the terminator
+#define COLLISION_BITS 20
+#define COLLISION_MASK (((uint64_t)1 << COLLISION_BITS) - 1)
+
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325
+#define FNV_PRIME 0x100000001B3
+
+struct Configuration
+{
+	const char* name;
+	enum jaDictionaryFlags flags;
+};
+
+static struct Configuration configurations[] = {
+    {"FNV1, linear hashing", JA_DICTIONARY_DEFAULT},
+    {"FNV1, open addressing", JA_DICTIONARY_OPEN_ADDRESSING},
+    {"Seeded, linear hashing", JA_DICTIONARY_SEEDED},
+    {"Seeded, open addressing", JA_DICTIONARY_SEEDED | JA_DICTIONARY_OPEN_ADDRESSING},
+};
+
+static const char* alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+
+static inline uint64_t sStep(uint64_t hash, char c)
+{
+	// As jaFNV1Hash(), the low bits only depend on the low bits
+	return (hash ^ (uint64_t)c) * FNV_PRIME;
+}
+
+
+static char* sGenerateKeys(size_t keys_no)
+{
+	// Meet in the middle, the state after 'prefix' and two characters
+	// forward, and the one that three more need to reach zero backward
+	size_t alphabet_len = strlen(alphabet);
+	uint16_t* forward = NULL;
+	char* keys = NULL;
+	char prefix[PREFIX_LEN];
+	size_t n = 0;
+
+	uint64_t inverse = FNV_PRIME; // Newton's method, modulo 2^64
+	for (int i = 0; i < 5; i++)
+		inverse *= 2 - FNV_PRIME * inverse;
+
+	if ((forward = malloc(sizeof(uint16_t) * (COLLISION_MASK + 1))) == NULL ||
+	    (keys = malloc(keys_no * KEY_LEN)) == NULL)
+		goto return_failure;
+
+	for (size_t p = 0; n < keys_no; p++)
+	{
+		uint64_t prefix_state = FNV_OFFSET_BASIS;
+		size_t prefix_len = (size_t)snprintf(prefix, PREFIX_LEN, "flood%zu-", p);
+
+		for (size_t i = 0; i < prefix_len; i++)
+			prefix_state = sStep(prefix_state, prefix[i]);
+
+		memset(forward, 0, sizeof(uint16_t) * (COLLISION_MASK + 1));
+
+		for (size_t m = 0; m < alphabet_len * alphabet_len; m++)
+		{
+			uint64_t state = sStep(sStep(prefix_state, alphabet[m / alphabet_len]), alphabet[m % alphabet_len]);
+			forward[state & COLLISION_MASK] = (uint16_t)(m + 1);
+		}
+
+		for (size_t s = 0; s < alphabet_len * alphabet_len * alphabet_len && n < keys_no; s++)
+		{
+			char c[3] = {alphabet[s / (alphabet_len * alphabet_len)], alphabet[(s / alphabet_len) % alphabet_len],
+			             alphabet[s % alphabet_len]};
+			uint64_t state = 0;
+			size_t m = 0;
+
+			for (int i = 2; i >= 0; i--)
+				state = (state * inverse) ^ (uint64_t)c[i];
+
+			if ((m = forward[state & COLLISION_MASK]) == 0)
+				continue;
+
+			m -= 1;
+			snprintf(keys + n * KEY_LEN, KEY_LEN, "%s%c%c%c%c%c", prefix, alphabet[m / alphabet_len],
+			         alphabet[m % alphabet_len], c[0], c[1], c[2]);
+
+			if ((jaFNV1Hash(keys + n * KEY_LEN, strlen(keys + n * KEY_LEN)) & COLLISION_MASK) != 0)
+				goto return_failure;
+
+			n += 1;
+		}
+	}
+
+	free(forward);
+	return keys;
+
+return_failure:
+	free(forward);
+	free(keys);
+	return NULL;
+}
+
+
+static void sBenchmark(enum jaDictionaryFlags flags, const char* keys, size_t keys_no)
+{
+	struct jaDictionary* d = NULL;
+	double start = 0.0;
+	size_t found = 0;
+
+	if ((d = jaDictionaryCreateEx(NULL, flags)) == NULL)
+		return;
+
+	start = Now();
+	for (size_t i = 0; i < keys_no; i++)
+		jaDictionaryAdd(d, keys + i * KEY_LEN, NULL, 0);
+	PrintResult("Insert", keys_no, Now() - start);
+
+	start = Now();
+	for (size_t i = 0; i < keys_no; i++)
+		found += (jaDictionaryGet(d, keys + i * KEY_LEN) != NULL) ? 1 : 0;
+	PrintResult("Lookup (hit)", keys_no, Now() - start);
+
+	jaDictionaryDelete(d);
+
+	if (found != keys_no)
+		printf(" - Error, %zu keys found of %zu!\n", found, keys_no);
+}
+
+
+int main(int argc, const char* argv[])
+{
+	size_t default_keys_no[] = {1000, 4000, 16000};
+	size_t runs_no = (argc > 1) ? (size_t)(argc - 1) : 3;
+
+	for (size_t r = 0; r < runs_no; r++)
+	{
+		size_t keys_no = (argc > 1) ? strtoul(argv[r + 1], NULL, 10) : default_keys_no[r];
+		char* keys = NULL;
+
+		if (keys_no == 0 || (keys = sGenerateKeys(keys_no)) == NULL)
+		{
+			fprintf(stderr, "Can't prepare %zu keys\n", keys_no);
+			return EXIT_FAILURE;
+		}
+
+		for (size_t c = 0; c < (sizeof(configurations) / sizeof(struct Configuration)); c++)
+		{
+			printf("\n%s, %zu colliding keys:\n", configurations[c].name, keys_no);
+			sBenchmark(configurations[c].flags, keys, keys_no);
+		}
+
+		free(keys);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+/*-----------------------------
+
+ [hashes.c]
+ - Alexander Brandt 2020
+
+ Usage: bench-hashes
+ Throughput and quality of the built-in hash functions.
+-----------------------------*/
+
+#include <string.h>
+
+#include "common.h"
+#include "japan-dictionary.h"
+
+
+#define THROUGHPUT_BYTES (256 * 1024 * 1024)
+#define AVALANCHE_KEYS 2000
+#define AVALANCHE_KEY_LEN 16
+#define DISTRIBUTION_KEYS 1000000
+#define DISTRIBUTION_BUCKETS 65536
+
+struct Function
+{
+	const char* name;
+	uint64_t (*function)(const char*, size_t);
+};
+
+
+static void sThroughput(struct Function f, const char* buffer)
+{
+	size_t sizes[] = {4, 8, 16, 32, 64, 256, 1024, 65536};
+	uint64_t sink = 0;
+
+	for (size_t s = 0; s < (sizeof(sizes) / sizeof(size_t)); s++)
+	{
+		size_t hashes_no = THROUGHPUT_BYTES / sizes[s];
+		double start = Now();
+
+		for (size_t i = 0; i < hashes_no; i++)
+			sink += f.function(buffer + (i & 63), sizes[s]); // Some misalignment
+
+		double seconds = Now() - start;
+
+		printf(" - %5zu bytes keys: %8.2f ns/hash, %6.2f GB/s\n", sizes[s],
+		       (seconds * 1000000000.0) / (double)hashes_no, ((double)THROUGHPUT_BYTES / seconds) / 1000000000.0);
+	}
+
+	if (sink == 0)
+		printf("(Improbable sink value)\n");
+}
+
+
+static void sAvalanche(struct Function f)
+{
+	// For every input bit flipped, every output bit should flip half of the times
+	static size_t flips[AVALANCHE_KEY_LEN * 8][64];
+	uint64_t state = 0xA5A5A5A5;
+	char key[AVALANCHE_KEY_LEN];
+
+	memset(flips, 0, sizeof(flips));
+
+	for (size_t k = 0; k < AVALANCHE_KEYS; k++)
+	{
+		for (size_t i = 0; i < AVALANCHE_KEY_LEN; i++)
+			key[i] = (char)Random(&state);
+
+		uint64_t original = f.function(key, AVALANCHE_KEY_LEN);
+
+		for (size_t in = 0; in < AVALANCHE_KEY_LEN * 8; in++)
+		{
+			key[in / 8] ^= (char)(1 << (in % 8));
+			uint64_t diff = original ^ f.function(key, AVALANCHE_KEY_LEN);
+			key[in / 8] ^= (char)(1 << (in % 8));
+
+			for (size_t out = 0; out < 64; out++)
+				flips[in][out] += (diff >> out) & 1;
+		}
+	}
+
+	double worst = 0.0;
+	double average = 0.0;
+
+	for (size_t in = 0; in < AVALANCHE_KEY_LEN * 8; in++)
+		for (size_t out = 0; out < 64; out++)
+		{
+			double bias = (double)flips[in][out] / (double)AVALANCHE_KEYS - 0.5;
+			bias = (bias < 0.0) ? -bias : bias;
+
+			average += bias / (double)(AVALANCHE_KEY_LEN * 8 * 64);
+			worst = (bias > worst) ? bias : worst;
+		}
+
+	printf(" - Avalanche bias: %.4f average, %.4f worst (0 is ideal)\n", average, worst);
+}
+
+
+static void sDistribution(struct Function f)
+{
+	// Sequential keys, as in a dictionary of assets, into buckets
+	// chosen by the low bits, as the dictionaries do
+	static size_t buckets[DISTRIBUTION_BUCKETS];
+	char key[32];
+
+	memset(buckets, 0, sizeof(buckets));
+
+	for (size_t i = 0; i < DISTRIBUTION_KEYS; i++)
+	{
+		int len = snprintf(key, 32, "asset/%zu", i);
+		buckets[f.function(key, (size_t)len) % DISTRIBUTION_BUCKETS] += 1;
+	}
+
+	double expected = (double)DISTRIBUTION_KEYS / (double)DISTRIBUTION_BUCKETS;
+	double chi = 0.0;
+
+	for (size_t i = 0; i < DISTRIBUTION_BUCKETS; i++)
+		chi += (((double)buckets[i] - expected) * ((double)buckets[i] - expected)) / expected;
+
+	printf(" - Distribution: %.4f chi-square / buckets (1 is ideal)\n", chi / (double)DISTRIBUTION_BUCKETS);
+}
+
+
+int main()
+{
+	struct Function functions[] = {{"FNV1", jaFNV1Hash}, {"WyHash", jaWyHash}};
+	char* buffer = NULL;
+	uint64_t state = 0x1234567;
+
+	if ((buffer = malloc(65536 + 64)) == NULL)
+		return EXIT_FAILURE;
+
+	for (size_t i = 0; i < 65536 + 64; i++)
+		buffer[i] = (char)Random(&state);
+
+	for (size_t f = 0; f < (sizeof(functions) / sizeof(struct Function)); f++)
+	{
+		printf("\n%s:\n", functions[f].name);
+		sAvalanche(functions[f]);
+		sDistribution(functions[f]);
+		sThroughput(functions[f], buffer);
+	}
+
+	free(buffer);
+	return EXIT_SUCCESS;
+}
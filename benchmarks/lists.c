@@ -0,0 +1,146 @@
+/*-----------------------------
+
+ [lists.c]
+ - Alexander Brandt 2020
+
+ Usage: bench-lists [objects_no] [objects_no] ...
+ Queue-like workloads, jaList (also pooled) against the intrusive
+ jaNodeList. Clear is measured as lists cleared every frame are.
+ Without arguments runs with 100, 10K and 1M objects.
+-----------------------------*/
+
+#include <string.h>
+
+#include "common.h"
+#include "japan-list.h"
+
+
+#define OPERATIONS 10000000
+
+struct Object
+{
+	uint64_t value;
+	struct jaListNode node;
+};
+
+
+static void sBenchmarkList(enum jaListFlags flags, struct Object* objects, size_t objects_no)
+{
+	struct jaList list = {0};
+	struct Object* object = NULL;
+	uint64_t sum = 0;
+	double start = 0.0;
+
+	list.flags = flags;
+
+	// Fill and drain
+	start = Now();
+	for (size_t i = 0; i < objects_no; i++)
+		jaListAdd(&list, &objects[i], 0);
+
+	while (list.first != NULL)
+	{
+		sum += ((struct Object*)list.first->data)->value;
+		jaListRemove(list.first);
+	}
+	PrintResult("Push and pop (burst)", objects_no * 2, Now() - start);
+
+	// Steady, one out and back in each time
+	for (size_t i = 0; i < objects_no; i++)
+		jaListAdd(&list, &objects[i], 0);
+
+	start = Now();
+	for (size_t i = 0; i < OPERATIONS; i++)
+	{
+		object = list.first->data;
+		sum += object->value;
+
+		jaListRemove(list.first);
+		jaListAdd(&list, object, 0);
+	}
+	PrintResult("Pop and push (steady)", OPERATIONS, Now() - start);
+
+	start = Now();
+	jaListClear(&list);
+	PrintResult("Clear", objects_no, Now() - start);
+
+	for (size_t i = 0; i < objects_no; i++)
+		jaListAdd(&list, &objects[i], 0);
+
+	start = Now();
+	jaListClear(&list);
+	PrintResult("Clear (again)", objects_no, Now() - start);
+
+	jaListClean(&list);
+	printf(" - Checksum: %lu\n", (unsigned long)sum);
+}
+
+
+static void sBenchmarkNodeList(struct Object* objects, size_t objects_no)
+{
+	struct jaNodeList list = {0};
+	struct jaListNode* node = NULL;
+	uint64_t sum = 0;
+	double start = 0.0;
+
+	start = Now();
+	for (size_t i = 0; i < objects_no; i++)
+		jaNodeListAdd(&list, &objects[i].node);
+
+	while ((node = jaNodeListPop(&list)) != NULL)
+		sum += JA_LIST_NODE_OWNER(node, struct Object, node)->value;
+	PrintResult("Push and pop (burst)", objects_no * 2, Now() - start);
+
+	for (size_t i = 0; i < objects_no; i++)
+		jaNodeListAdd(&list, &objects[i].node);
+
+	start = Now();
+	for (size_t i = 0; i < OPERATIONS; i++)
+	{
+		node = jaNodeListPop(&list);
+		sum += JA_LIST_NODE_OWNER(node, struct Object, node)->value;
+
+		jaNodeListAdd(&list, node);
+	}
+	PrintResult("Pop and push (steady)", OPERATIONS, Now() - start);
+
+	while (jaNodeListPop(&list) != NULL)
+		;
+
+	printf(" - Checksum: %lu\n", (unsigned long)sum);
+}
+
+
+int main(int argc, const char* argv[])
+{
+	size_t default_objects_no[] = {100, 10000, 1000000};
+	size_t runs_no = (argc > 1) ? (size_t)(argc - 1) : 3;
+
+	for (size_t r = 0; r < runs_no; r++)
+	{
+		size_t objects_no = (argc > 1) ? strtoul(argv[r + 1], NULL, 10) : default_objects_no[r];
+		struct Object* objects = NULL;
+
+		if (objects_no == 0 || (objects = calloc(objects_no, sizeof(struct Object))) == NULL)
+		{
+			fprintf(stderr, "Can't prepare %zu objects\n", objects_no);
+			return EXIT_FAILURE;
+		}
+
+		for (size_t i = 0; i < objects_no; i++)
+			objects[i].value = i;
+
+		printf("\nList, %zu objects:\n", objects_no);
+		sBenchmarkList(JA_LIST_DEFAULT, objects, objects_no);
+
+		printf("\nList (pooled), %zu objects:\n", objects_no);
+		sBenchmarkList(JA_LIST_POOLED, objects, objects_no);
+
+		printf("\nNode list (intrusive), %zu objects:\n", objects_no);
+		sBenchmarkNodeList(objects, objects_no);
+
+		free(objects);
+	}
+
+	return EXIT_SUCCESS;
+}
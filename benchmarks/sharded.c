@@ -0,0 +1,152 @@
+/*-----------------------------
+
+ [sharded.c]
+ - Alexander Brandt 2020
+
+ Usage: bench-sharded [keys_no]
+ Additions from 1 to all cores, over a dictionary behind a mutex
+ and a sharded one. Without arguments uses 1M keys.
+-----------------------------*/
+
+#include <string.h>
+
+#include "common.h"
+#include "japan-dictionary.h"
+
+
+#define KEY_LEN 32 // "asset/" and 20 digits fit
+
+enum Mode
+{
+	MODE_MUTEX,
+	MODE_SHARDED
+};
+
+struct Shared
+{
+	enum Mode mode;
+	struct jaDictionary* d;
+	Mutex mutex;
+
+	const char* keys;
+	size_t keys_no;
+};
+
+struct Writer
+{
+	struct Shared* shared;
+	size_t start;
+	size_t end;
+	size_t added;
+};
+
+
+static void sWriter(void* data)
+{
+	struct Writer* writer = data;
+	struct Shared* shared = writer->shared;
+
+	// Each thread adds its own range of keys
+	for (size_t i = writer->start; i < writer->end; i++)
+	{
+		const char* key = shared->keys + i * KEY_LEN;
+
+		if (shared->mode == MODE_MUTEX)
+		{
+			MutexLock(&shared->mutex);
+			writer->added += (jaDictionaryAdd(shared->d, key, NULL, 0) != NULL) ? 1 : 0;
+			MutexUnlock(&shared->mutex);
+		}
+		else
+			writer->added += (jaDictionaryAdd(shared->d, key, NULL, 0) != NULL) ? 1 : 0;
+	}
+}
+
+
+static void sBenchmark(struct Shared* shared, size_t threads_no)
+{
+	Thread* threads = malloc(sizeof(Thread) * threads_no);
+	struct Writer* writers = calloc(threads_no, sizeof(struct Writer));
+	struct ThreadStart* starts = malloc(sizeof(struct ThreadStart) * threads_no);
+	size_t added = 0;
+
+	if (threads == NULL || writers == NULL || starts == NULL)
+		goto return_failure;
+
+	if (shared->mode == MODE_MUTEX)
+		shared->d = jaDictionaryCreate(NULL);
+	else
+		shared->d = jaDictionaryCreateSharded(NULL, JA_DICTIONARY_SHARDED, CoresNo() * 4);
+
+	double start = Now();
+
+	for (size_t i = 0; i < threads_no; i++)
+	{
+		writers[i].shared = shared;
+		writers[i].start = (shared->keys_no * i) / threads_no;
+		writers[i].end = (shared->keys_no * (i + 1)) / threads_no;
+		starts[i].function = sWriter;
+		starts[i].data = &writers[i];
+
+		if (ThreadCreate(&threads[i], &starts[i]) != 0)
+			threads_no = i; // Measure what we have
+	}
+
+	for (size_t i = 0; i < threads_no; i++)
+	{
+		ThreadJoin(threads[i]);
+		added += writers[i].added;
+	}
+
+	double seconds = Now() - start;
+	char name[64];
+
+	snprintf(name, 64, "%zu threads", threads_no);
+	PrintResult(name, added, seconds);
+
+	if (threads_no != 0 && added != writers[threads_no - 1].end)
+		printf(" - Error, %zu keys added of %zu!\n", added, writers[threads_no - 1].end);
+
+	jaDictionaryDelete(shared->d);
+
+return_failure:
+	free(threads);
+	free(writers);
+	free(starts);
+}
+
+
+int main(int argc, const char* argv[])
+{
+	struct Shared shared = {0};
+	size_t cores_no = CoresNo();
+	char* keys = NULL;
+
+	shared.keys_no = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+
+	if (shared.keys_no == 0 || (keys = malloc(shared.keys_no * KEY_LEN)) == NULL)
+	{
+		fprintf(stderr, "Can't prepare %zu keys\n", shared.keys_no);
+		return EXIT_FAILURE;
+	}
+
+	for (size_t i = 0; i < shared.keys_no; i++)
+		snprintf(keys + i * KEY_LEN, KEY_LEN, "asset/%zu", i);
+
+	shared.keys = keys;
+	MutexInit(&shared.mutex);
+
+	const char* names[] = {"Add() behind a mutex", "Sharded Add()"};
+
+	for (int m = MODE_MUTEX; m <= MODE_SHARDED; m++)
+	{
+		printf("\n%s, %zu keys:\n", names[m], shared.keys_no);
+		shared.mode = (enum Mode)m;
+
+		for (size_t threads_no = 1; threads_no < cores_no * 2; threads_no *= 2)
+			sBenchmark(&shared, (threads_no < cores_no) ? threads_no : cores_no);
+	}
+
+	free(keys);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+/*-----------------------------
+
+ [strings.c]
+ - Alexander Brandt 2020
+
+ Usage: bench-strings [mib]
+ UTF8 validation of texts with units of one to four bytes, by
+ jaStringValidateUTF8() against a loop of jaUnitValidateUTF8().
+ Results are per byte. Without arguments validates 16 MiB. Then
+ short strings, per string, given with 'n' as a maximum as the
+ configuration does with keys and arguments.
+-----------------------------*/
+
+#include <string.h>
+
+#include "common.h"
+#include "japan-string.h"
+
+
+#define ROUNDS 8
+#define SHORT_ROUNDS 1000000
+#define SHORT_MAX 4096
+
+static const char* s_units[] = {"a", "ñ", "ム", "🐦"};
+static const char* s_names[] = {"ASCII", "Two bytes", "Three bytes", "Four bytes", "Mixed (mostly ASCII)"};
+static const char* s_short[] = {"render.width", "--window.fullscreen=1",
+                                "Ñandú, pingüino, cóndor, águila y búho!"};
+
+
+static void sFill(uint8_t* text, size_t size, int kind, uint64_t* state)
+{
+	size_t i = 0;
+
+	while (i < size - 4)
+	{
+		const char* unit = NULL;
+
+		if (kind < 4)
+			unit = s_units[kind];
+		else
+			unit = s_units[((Random(state) % 16) == 0) ? (1 + Random(state) % 3) : 0];
+
+		memcpy(text + i, unit, strlen(unit));
+		i += strlen(unit);
+	}
+
+	memset(text + i, ' ', size - i);
+}
+
+
+int main(int argc, const char* argv[])
+{
+	size_t size = ((argc > 1) ? strtoul(argv[1], NULL, 10) : 16) * 1024 * 1024;
+	uint8_t* text = NULL;
+	uint64_t state = 0x1234567;
+
+	if (size == 0 || (text = malloc(size)) == NULL)
+	{
+		fprintf(stderr, "Can't prepare %zu bytes\n", size);
+		return EXIT_FAILURE;
+	}
+
+	for (int kind = 0; kind < 5; kind++)
+	{
+		size_t bytes = 0;
+		size_t units = 0;
+		size_t unit_len = 0;
+		double start = 0.0;
+
+		sFill(text, size, kind, &state);
+		printf("\n%s, %zu bytes:\n", s_names[kind], size);
+
+		start = Now();
+		for (int r = 0; r < ROUNDS; r++)
+			jaStringValidateUTF8(text, size, &bytes, &units);
+		PrintResult("Validate string", size * ROUNDS, Now() - start);
+
+		start = Now();
+		for (int r = 0; r < ROUNDS; r++)
+		{
+			for (bytes = 0, units = 0; bytes < size; bytes += unit_len, units++)
+			{
+				if (jaUnitValidateUTF8(text + bytes, size - bytes, &unit_len, NULL) != 0)
+					break;
+			}
+		}
+		PrintResult("Validate units (one by one)", size * ROUNDS, Now() - start);
+
+		printf(" - Units: %zu\n", units);
+	}
+
+	// Short strings, copied into a bigger buffer
+	memset(text, 0, SHORT_MAX);
+
+	for (size_t s = 0; s < sizeof(s_short) / sizeof(const char*); s++)
+	{
+		size_t bytes = 0;
+		size_t units = 0;
+		size_t unit_len = 0;
+		size_t checksum = 0;
+		double start = 0.0;
+
+		memcpy(text + 1, s_short[s], strlen(s_short[s]) + 1); // Misaligned, as usual
+		printf("\n\"%s\", %zu bytes:\n", s_short[s], strlen(s_short[s]));
+
+		start = Now();
+		for (int r = 0; r < SHORT_ROUNDS; r++)
+		{
+			jaStringValidateUTF8(text + 1, SHORT_MAX - 1, &bytes, &units);
+			checksum += units;
+		}
+		PrintResult("Validate string", SHORT_ROUNDS, Now() - start);
+
+		start = Now();
+		for (int r = 0; r < SHORT_ROUNDS; r++)
+		{
+			for (bytes = 1, units = 0; bytes < SHORT_MAX; bytes += unit_len)
+			{
+				if (jaUnitValidateUTF8(text + bytes, SHORT_MAX - bytes, &unit_len, NULL) != 0)
+					break;
+
+				units += 1;
+
+				if (text[bytes] == 0x00)
+					break;
+			}
+
+			checksum += units;
+		}
+		PrintResult("Validate units (one by one)", SHORT_ROUNDS, Now() - start);
+
+		printf(" - Checksum: %zu\n", checksum);
+	}
+
+	free(text);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,230 @@
+/*-----------------------------
+
+ [trees.c]
+ - Alexander Brandt 2020
+
+ Usage: bench-trees [nodes_no] [nodes_no] ...
+ Scene graph like traversals, each node accumulating the value
+ of its parent, on jaTree against jaFlatTree. Parallel ones use
+ 4 workers. Parents are random
+ among previous nodes, so depth-first order isn't that of creation.
+ Without arguments runs with 100K and 1M nodes.
+-----------------------------*/
+
+#include <string.h>
+
+#include "common.h"
+#include "japan-tree.h"
+
+
+#define WORKERS 4
+
+struct Transform
+{
+	float local;
+	float world;
+};
+
+
+static void sAccumulate(struct jaTree* tree, const void* parent_world, void* world, void* extra_data)
+{
+	struct Transform* transform = tree->data;
+	(void)extra_data;
+
+	transform->world = transform->local + *(const float*)parent_world;
+	*(float*)world = transform->world;
+}
+
+
+static uint32_t* sGenerateParents(size_t nodes_no)
+{
+	uint32_t* parent = NULL;
+	uint64_t state = 0x1234567;
+
+	if ((parent = malloc(sizeof(uint32_t) * nodes_no)) != NULL)
+	{
+		parent[0] = JA_FLAT_TREE_NONE;
+
+		for (size_t i = 1; i < nodes_no; i++)
+			parent[i] = (uint32_t)(Random(&state) % i);
+	}
+
+	return parent;
+}
+
+
+static void sBenchmarkTree(const uint32_t* parent, size_t nodes_no)
+{
+	struct jaTree** node = NULL;
+	struct jaTree* tree = NULL;
+	struct jaTreeState state = {0};
+	struct jaTreeCursor cursor = {0};
+	struct jaBuffer buffer = {0};
+	struct Transform t = {1.0f, 0.0f};
+	struct Transform* transform = NULL;
+	double start = 0.0;
+	float sum = 0.0f;
+
+	if ((node = malloc(sizeof(struct jaTree*) * nodes_no)) == NULL)
+		return;
+
+	start = Now();
+	for (size_t i = 0; i < nodes_no; i++)
+		node[i] = jaTreeCreate((i == 0) ? NULL : node[parent[i]], &t, sizeof(struct Transform));
+	PrintResult("Build", nodes_no, Now() - start);
+
+	for (int r = 0; r < 2; r++)
+	{
+		start = Now();
+		state.start = node[0];
+
+		while ((tree = jaTreeIterate(&state, &buffer)) != NULL)
+		{
+			transform = tree->data;
+			transform->world = transform->local;
+
+			if (tree->parent != NULL)
+				transform->world += ((struct Transform*)tree->parent->data)->world;
+
+			sum += transform->world;
+		}
+		PrintResult((r == 0) ? "Traverse" : "Traverse (again)", nodes_no, Now() - start);
+	}
+
+	// Stackless, following parents
+	start = Now();
+	cursor.start = node[0];
+
+	while ((tree = jaTreeIterateNext(&cursor)) != NULL)
+	{
+		transform = tree->data;
+		transform->world = transform->local;
+
+		if (tree->parent != NULL)
+			transform->world += ((struct Transform*)tree->parent->data)->world;
+
+		sum += transform->world;
+	}
+	PrintResult("Traverse (cursor)", nodes_no, Now() - start);
+
+	start = Now();
+	jaTreeIterateParallel(node[0], WORKERS, sAccumulate, sizeof(float), NULL, NULL);
+	PrintResult("Traverse (parallel)", nodes_no, Now() - start);
+	sum += ((struct Transform*)node[nodes_no - 1]->data)->world;
+
+	start = Now();
+	jaTreeDelete(node[0]);
+	PrintResult("Delete", nodes_no, Now() - start);
+
+	for (size_t i = 0; i < nodes_no; i++)
+		node[i] = jaTreeCreate((i == 0) ? NULL : node[parent[i]], &t, sizeof(struct Transform));
+
+	start = Now();
+	jaTreeDeleteParallel(node[0], WORKERS);
+	PrintResult("Delete (parallel)", nodes_no, Now() - start);
+
+	// Pooled, without callbacks
+	start = Now();
+	node[0] = jaTreeCreatePool(&t, sizeof(struct Transform), NULL, JA_TREE_POOL_DEFAULT);
+	for (size_t i = 1; i < nodes_no; i++)
+		node[i] = jaTreeCreate(node[parent[i]], &t, sizeof(struct Transform));
+	PrintResult("Build (pooled)", nodes_no, Now() - start);
+
+	start = Now();
+	jaTreeDelete(node[0]);
+	PrintResult("Delete (pooled)", nodes_no, Now() - start);
+
+	jaBufferClean(&buffer);
+	free(node);
+	printf(" - Checksum: %.0f\n", (double)sum);
+}
+
+
+static void sBenchmarkFlatTree(const uint32_t* parent, size_t nodes_no)
+{
+	struct jaFlatTree tree = {0};
+	struct jaFlatTreeNode* nodes = NULL;
+	struct Transform t = {1.0f, 0.0f};
+	struct Transform* transform = NULL;
+	double start = 0.0;
+	float sum = 0.0f;
+
+	tree.data_size = sizeof(struct Transform);
+
+	start = Now();
+	for (size_t i = 0; i < nodes_no; i++)
+		jaFlatTreeAdd(&tree, parent[i], &t);
+	PrintResult("Build", nodes_no, Now() - start);
+
+	// Following links, as nodes aren't in depth-first order
+	start = Now();
+	for (uint32_t i = jaFlatTreeNext(&tree, JA_FLAT_TREE_NONE); i != JA_FLAT_TREE_NONE; i = jaFlatTreeNext(&tree, i))
+	{
+		transform = jaFlatTreeData(&tree, i);
+		transform->world = transform->local;
+
+		if (jaFlatTreeNode(&tree, i)->parent != JA_FLAT_TREE_NONE)
+			transform->world += ((struct Transform*)jaFlatTreeData(&tree, jaFlatTreeNode(&tree, i)->parent))->world;
+
+		sum += transform->world;
+	}
+	PrintResult("Traverse (links)", nodes_no, Now() - start);
+
+	start = Now();
+	jaFlatTreeCompact(&tree);
+	PrintResult("Compact", nodes_no, Now() - start);
+
+	// Now a linear scan
+	for (int r = 0; r < 2; r++)
+	{
+		start = Now();
+		nodes = tree.nodes.data;
+		transform = tree.data.data;
+
+		for (size_t i = 0; i < tree.nodes_no; i++)
+		{
+			transform[i].world = transform[i].local;
+
+			if (nodes[i].parent != JA_FLAT_TREE_NONE)
+				transform[i].world += transform[nodes[i].parent].world;
+
+			sum += transform[i].world;
+		}
+		PrintResult((r == 0) ? "Traverse (linear)" : "Traverse (linear, again)", nodes_no, Now() - start);
+	}
+
+	start = Now();
+	jaFlatTreeClean(&tree);
+	PrintResult("Delete", nodes_no, Now() - start);
+
+	printf(" - Checksum: %.0f\n", (double)sum);
+}
+
+
+int main(int argc, const char* argv[])
+{
+	size_t default_nodes_no[] = {100000, 1000000};
+	size_t runs_no = (argc > 1) ? (size_t)(argc - 1) : 2;
+
+	for (size_t r = 0; r < runs_no; r++)
+	{
+		size_t nodes_no = (argc > 1) ? strtoul(argv[r + 1], NULL, 10) : default_nodes_no[r];
+		uint32_t* parent = NULL;
+
+		if (nodes_no == 0 || nodes_no >= JA_FLAT_TREE_REMOVED || (parent = sGenerateParents(nodes_no)) == NULL)
+		{
+			fprintf(stderr, "Can't prepare %zu nodes\n", nodes_no);
+			return EXIT_FAILURE;
+		}
+
+		printf("\nTree, %zu nodes:\n", nodes_no);
+		sBenchmarkTree(parent, nodes_no);
+
+		printf("\nFlat tree, %zu nodes:\n", nodes_no);
+		sBenchmarkFlatTree(parent, nodes_no);
+
+		free(parent);
+	}
+
+	return EXIT_SUCCESS;
+}
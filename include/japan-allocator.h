@@ -0,0 +1,24 @@
+/*-----------------------------
+
+ [japan-allocator.h]
+ - Alexander Brandt 2020
+-----------------------------*/
+
+#ifndef JAPAN_ALLOCATOR_H
+#define JAPAN_ALLOCATOR_H
+
+#include <stddef.h>
+
+// Where a dictionary, list, tree, buffer, image or sound takes its memory
+// from. It must outlive them, and be thread safe if they are used from many
+// threads. Wherever one is accepted NULL means malloc(), realloc() and free()
+struct jaAllocator
+{
+	void* (*allocate)(size_t size, void* context);
+	void* (*reallocate)(void* ptr, size_t size, void* context); // 'ptr' may be NULL
+	void (*deallocate)(void* ptr, void* context);               // 'ptr' never is
+
+	void* context;
+};
+
+#endif
@@ -18,10 +18,31 @@
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
+#include "japan-allocator.h"
+
+enum jaBufferFlags
+{
+	JA_BUFFER_DEFAULT = 0,
+	JA_BUFFER_ALIGN_32 = 1 << 0,   // Data aligned for SIMD loads, otherwise only as malloc() does
+	JA_BUFFER_ALIGN_64 = 1 << 1,   // "
+	JA_BUFFER_HUGE_PAGES = 1 << 2  // Sizes from 2 MiB mapped in huge pages, where available (Linux)
+};
 
 struct jaBuffer
 {
 	void* data;
+	size_t size;     // Capacity, what is allocated
+	size_t length;   // What is used, by the Append() functions
+	unsigned growth; // Percentage of the required size allocated when growing, 200 if zero
+
+	enum jaBufferFlags flags;             // Only change them while 'data' is NULL
+	const struct jaAllocator* allocator; // ", huge pages are always mapped
+};
+
+struct jaBufferView
+{
+	const void* data; // Not owned, it must outlive the view
 	size_t size;
 };
 
@@ -30,4 +51,21 @@ JA_EXPORT int jaBufferCopy(struct jaBuffer* dest, const struct jaBuffer* org);
 JA_EXPORT void* jaBufferResize(struct jaBuffer* buffer, size_t new_size);
 JA_EXPORT void* jaBufferResizeZero(struct jaBuffer* buffer, size_t new_size);
 
+// Length grows with appends, the capacity only when required (geometrically, so
+// each one is O(1) amortized) or reserved. Clear() keeps it, ShrinkToFit() doesn't.
+// Append() returns where 'n' bytes were copied, or just made room if 'data' is NULL
+JA_EXPORT void* jaBufferReserve(struct jaBuffer* buffer, size_t capacity);
+JA_EXPORT int jaBufferShrinkToFit(struct jaBuffer* buffer);
+JA_EXPORT void jaBufferClear(struct jaBuffer* buffer);
+JA_EXPORT void* jaBufferAppend(struct jaBuffer* buffer, const void* data, size_t n);
+JA_EXPORT int jaBufferAppendByte(struct jaBuffer* buffer, uint8_t byte);
+
+// Views never allocate nor copy, slices are clamped to the viewed bytes
+JA_EXPORT struct jaBufferView jaBufferViewOf(const void* data, size_t size);
+JA_EXPORT struct jaBufferView jaBufferViewString(const char* string);
+JA_EXPORT struct jaBufferView jaBufferViewSlice(struct jaBufferView view, size_t offset, size_t size);
+JA_EXPORT size_t jaBufferViewFind(struct jaBufferView view, uint8_t byte); // Returns 'view.size' if not found
+JA_EXPORT int jaBufferViewEqual(struct jaBufferView a, struct jaBufferView b);
+JA_EXPORT int jaBufferCopyView(struct jaBuffer* dest, struct jaBufferView org);
+
 #endif
@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <limits.h>
 
+#include "japan-allocator.h"
 #include "japan-status.h"
 #include "japan-string.h"
 
@@ -39,6 +40,7 @@ struct jaConfiguration;
 struct jaCvar;
 
 JA_EXPORT struct jaConfiguration* jaConfigurationCreate();
+JA_EXPORT struct jaConfiguration* jaConfigurationCreateWith(const struct jaAllocator*); // Cvars and their strings
 JA_EXPORT void jaConfigurationDelete(struct jaConfiguration*);
 
 JA_EXPORT void jaConfigurationArguments(struct jaConfiguration* config, enum jaEncode, int argc, const char* argv[]);
@@ -55,10 +57,12 @@ JA_EXPORT struct jaCvar* jaCvarCreateString(struct jaConfiguration*, const char*
                                             struct jaStatus*);
 
 JA_EXPORT struct jaCvar* jaCvarGet(const struct jaConfiguration*, const char* name);
+JA_EXPORT struct jaCvar* jaCvarGetView(const struct jaConfiguration*, struct jaBufferView name);
 JA_EXPORT void jaCvarDelete(struct jaCvar* cvar);
 
 JA_EXPORT int jaCvarGetValueInt(const struct jaCvar*, int* dest, struct jaStatus*);
 JA_EXPORT int jaCvarGetValueFloat(const struct jaCvar*, float* dest, struct jaStatus*);
 JA_EXPORT int jaCvarGetValueString(const struct jaCvar*, const char** dest, struct jaStatus*);
+JA_EXPORT int jaCvarGetValueView(const struct jaCvar*, struct jaBufferView* dest, struct jaStatus*); // Of the string
 
 #endif
@@ -19,8 +19,25 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include "japan-allocator.h"
+
+#define JA_DICTIONARY_STATE_BUFFER 16
+#define JA_DICTIONARY_HISTOGRAM_LEN 8
 
 struct jaDictionary;
+struct jaFrozenDictionary;
+
+enum jaDictionaryFlags
+{
+	JA_DICTIONARY_DEFAULT = 0,
+	JA_DICTIONARY_OPEN_ADDRESSING = 1 << 0, // Flat table with fingerprints, instead of linear hashing buckets
+	JA_DICTIONARY_WYHASH = 1 << 1,          // If no hash function is provided, use jaWyHash() instead of FNV1
+	JA_DICTIONARY_ARENA = 1 << 2,           // Items allocated in chunks, all freed at once by jaDictionaryDelete()
+	JA_DICTIONARY_CONCURRENT = 1 << 3,      // Lock-free Get() for many threads, implies open addressing (see below)
+	JA_DICTIONARY_SHARDED = 1 << 4,         // Independent tables, each one with a lock (see below)
+	JA_DICTIONARY_STATS = 1 << 5,           // Count lookups, probes and resizes, timing the last ones
+	JA_DICTIONARY_SEEDED = 1 << 6           // Keyed SipHash-1-3 with a random key, ignores the hash function
+};
 
 struct jaDictionaryItem
 {
@@ -29,22 +46,133 @@ struct jaDictionaryItem
 	void (*callback_delete)(struct jaDictionaryItem*);
 
 	void* data;
+
+	uint64_t hash;   // Computed once, at addition
+	size_t key_size; // Without the NULL terminator
 	char key[];
 };
 
+struct jaDictionaryState
+{
+	struct jaDictionary* start; // Set before iterate
+	struct jaDictionaryItem* actual;
+
+	struct jaDictionary* dictionary;
+	struct jaDictionary* table; // The dictionary or one of its shards, NULL at the end
+	size_t shard;
+
+	size_t index; // Bucket or slot
+	size_t depth; // In the bucket
+	void* bucket;
+	const void* slots;
+
+	size_t buffered_no; // Items ahead, for IterateNext()
+	size_t buffered_cursor;
+	struct jaDictionaryItem* buffer[JA_DICTIONARY_STATE_BUFFER];
+};
+
+struct jaDictionaryStats
+{
+	size_t items_no;
+	size_t tombstones_no;
+	size_t buckets_no; // Or slots in open addressing
+	size_t level;      // Linear hashing ones, zero if sharded
+	size_t pointer;    // "
+	unsigned load;     // Percentage, as the thresholds
+
+	// Addresses by number of overflow buckets (linear hashing), or items by
+	// distance to their slot (open addressing). The last counts longer ones
+	size_t histogram[JA_DICTIONARY_HISTOGRAM_LEN];
+
+	// Since creation, if JA_DICTIONARY_STATS
+	size_t lookups_no;
+	size_t probes_no; // Items slots visited by lookups
+	size_t resizes_no;
+	uint64_t resizes_ns;
+	uint64_t resize_max_ns; // Longest pause
+};
+
 JA_EXPORT uint64_t jaFNV1Hash(const char* key, size_t size);
+JA_EXPORT uint64_t jaWyHash(const char* key, size_t size);
 
 JA_EXPORT struct jaDictionary* jaDictionaryCreate(uint64_t (*hash_function)(const char*, size_t));
+JA_EXPORT struct jaDictionary* jaDictionaryCreateEx(uint64_t (*hash_function)(const char*, size_t),
+                                                    enum jaDictionaryFlags flags);
+JA_EXPORT struct jaDictionary* jaDictionaryCreateSharded(uint64_t (*hash_function)(const char*, size_t),
+                                                         enum jaDictionaryFlags flags, size_t shards_no);
+JA_EXPORT struct jaDictionary* jaDictionaryCreateWith(uint64_t (*hash_function)(const char*, size_t),
+                                                      enum jaDictionaryFlags flags, size_t shards_no,
+                                                      const struct jaAllocator* allocator);
 JA_EXPORT void jaDictionaryDelete(struct jaDictionary* dictionary);
 
 JA_EXPORT struct jaDictionaryItem* jaDictionaryAdd(struct jaDictionary* dictionary, const char* key, void* data,
                                                    size_t data_size);
 JA_EXPORT struct jaDictionaryItem* jaDictionaryGet(const struct jaDictionary* dictionary, const char* key);
 
+JA_EXPORT struct jaDictionaryItem* jaDictionaryAddN(struct jaDictionary* dictionary, const char* key, size_t key_size,
+                                                    void* data, size_t data_size);
+JA_EXPORT struct jaDictionaryItem* jaDictionaryGetN(const struct jaDictionary* dictionary, const char* key,
+                                                    size_t key_size);
+JA_EXPORT int jaDictionaryReserve(struct jaDictionary* dictionary, size_t items_no);
+JA_EXPORT int jaDictionaryAddBatch(struct jaDictionary* dictionary, size_t items_no, const char* const* keys,
+                                   void* const* data, size_t data_size);
+
+// Load factor percentages at which the table grows and shrinks, zero to never shrink.
+// The shrink one should be below the grow one, and below half of it in open addressing
+JA_EXPORT int jaDictionarySetThresholds(struct jaDictionary* dictionary, unsigned grow, unsigned shrink);
+JA_EXPORT int jaDictionaryGetStats(struct jaDictionary* dictionary, struct jaDictionaryStats* out);
+
+JA_EXPORT int jaDictionaryRemoveN(struct jaDictionary* dictionary, const char* key, size_t key_size);
+
 JA_EXPORT void jaDictionaryRemove(struct jaDictionaryItem* item);
-JA_EXPORT int jaDictionaryDetach(struct jaDictionaryItem* item);
+JA_EXPORT int jaDictionaryDetach(struct jaDictionaryItem* item); // Arena items are still freed by the dictionary,
+                                                                  // others with its allocator
 
 JA_EXPORT void jaDictionaryIterate(struct jaDictionary*, void (*callback)(struct jaDictionaryItem*, void*),
                                    void* extra_data);
+JA_EXPORT void jaDictionaryIterateParallel(struct jaDictionary*, size_t workers_no,
+                                           void (*callback)(struct jaDictionaryItem*, void*), void* extra_data);
+
+// Walks the table in memory order, until returning NULL (or zero for Batch()). It
+// can be paused and resumed at will, as long the dictionary is not modified. With
+// JA_DICTIONARY_CONCURRENT do it from a read section, sharded ones aren't locked
+JA_EXPORT struct jaDictionaryItem* jaDictionaryIterateNext(struct jaDictionaryState* state);
+JA_EXPORT size_t jaDictionaryIterateBatch(struct jaDictionaryState* state, struct jaDictionaryItem** items,
+                                          size_t items_no);
+
+// With JA_DICTIONARY_CONCURRENT, Get() and the use of the returned item should be
+// enclosed between ReadBegin() and ReadEnd(), where removed items remain valid.
+// Writer functions can be called from any thread, they take a lock, except from
+// a read section or a callback. Deletion callbacks run once no reader holds the
+// item, and Detach() waits for that before returning
+JA_EXPORT size_t jaDictionaryReadBegin(struct jaDictionary* dictionary);
+JA_EXPORT void jaDictionaryReadEnd(struct jaDictionary* dictionary, size_t token);
+
+// Immutable copy, with keys packed and a minimal perfect hash. Also a flat blob to store
+// in a file and load back (from the same byte order), it must remain valid meanwhile.
+// Get() returns the 'data_size' bytes copied at freeze, or the key if that was zero.
+// Freeze() isn't an atomic snapshot, items added meanwhile by other threads may
+// be left out (and removing them is unsafe, as in any iteration)
+JA_EXPORT struct jaFrozenDictionary* jaDictionaryFreeze(struct jaDictionary* dictionary, size_t data_size);
+JA_EXPORT struct jaFrozenDictionary* jaFrozenDictionaryLoad(const void* blob, size_t size);
+JA_EXPORT void jaFrozenDictionaryDelete(struct jaFrozenDictionary* frozen);
+
+JA_EXPORT const void* jaFrozenDictionaryGet(const struct jaFrozenDictionary* frozen, const char* key);
+JA_EXPORT const void* jaFrozenDictionaryGetN(const struct jaFrozenDictionary* frozen, const char* key,
+                                             size_t key_size);
+JA_EXPORT const void* jaFrozenDictionaryBlob(const struct jaFrozenDictionary* frozen, size_t* size);
+
+// With JA_DICTIONARY_SEEDED, every dictionary draws its own random key (from the
+// system, or the clock if it fails). Use it when keys come from outside (files,
+// arguments, the network), so nobody can craft many of them sharing a bucket.
+// Hashes are different on each run, so don't store them
+
+// With JA_DICTIONARY_SHARDED, keys are routed by high bits of their hash to one
+// of many tables (16 by default), so threads adding keys rarely wait for each other.
+// Every function can be called from any thread, except from a callback. Items belong
+// to their shard ('item->dictionary'), and only another thread removing them can
+// invalidate those returned by Get(). IterateParallel() hands a shard at a time
+// to each worker, callbacks never see items of the same shard at the same time.
+// Not compatible with JA_DICTIONARY_CONCURRENT
 
 #endif
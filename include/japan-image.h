@@ -20,6 +20,8 @@
 #include <stddef.h>
 #include <stdio.h>
 
+#include "japan-allocator.h"
+#include "japan-buffer.h"
 #include "japan-endianness.h"
 #include "japan-status.h"
 
@@ -47,6 +49,7 @@ struct jaImage
 	size_t size; // In bytes
 
 	void* data;
+	const struct jaAllocator* allocator; // Where the image and its data came from
 };
 
 struct jaImageEx
@@ -65,9 +68,14 @@ struct jaImageEx
 };
 
 JA_EXPORT struct jaImage* jaImageCreate(enum jaImageFormat, size_t width, size_t height, size_t channels);
+JA_EXPORT struct jaImage* jaImageCreateEx(enum jaImageFormat, size_t width, size_t height, size_t channels,
+                                          enum jaBufferFlags); // Aligned or in huge pages data
+JA_EXPORT struct jaImage* jaImageCreateWith(enum jaImageFormat, size_t width, size_t height, size_t channels,
+                                            enum jaBufferFlags, const struct jaAllocator*);
 JA_EXPORT void jaImageDelete(struct jaImage* image);
 
 JA_EXPORT struct jaImage* jaImageLoad(const char* filename, struct jaStatus*);
+JA_EXPORT struct jaImage* jaImageLoadWith(const char* filename, const struct jaAllocator*, struct jaStatus*);
 JA_EXPORT int jaImageSaveSgi(const struct jaImage* image, const char* filename, struct jaStatus*);
 JA_EXPORT int jaImageSaveRaw(const struct jaImage* image, const char* filename, struct jaStatus*);
 
@@ -19,14 +19,35 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include "japan-allocator.h"
 
 struct jaListItem;
+struct jaListChunk;
+
+enum jaListFlags
+{
+	JA_LIST_DEFAULT = 0,
+	JA_LIST_POOLED = 1 << 0 // Items from chunks owned by the list, recycled once removed
+};
+
+struct jaListPool
+{
+	struct jaListChunk* first;
+	struct jaListChunk* actual;
+	struct jaListItem* spare_items;
+	size_t chunk_size; // Of the next chunk
+};
 
 struct jaList
 {
 	struct jaListItem* first;
 	struct jaListItem* last;
 	size_t items_no;
+
+	const struct jaAllocator* allocator; // Set before adding items, NULL for malloc()
+	enum jaListFlags flags;               // "
+
+	struct jaListPool pool; // Private, if JA_LIST_POOLED
 };
 
 struct jaListItem
@@ -36,6 +57,8 @@ struct jaListItem
 	struct jaListItem* previous;
 
 	void (*callback_delete)(struct jaListItem*);
+	const struct jaAllocator* allocator; // That of its list, also once detached
+	struct jaList* pool;                 // ", if pooled
 
 	void* data;
 };
@@ -49,7 +72,38 @@ struct jaListState
 	struct jaListItem* future_return;
 };
 
+struct jaListNode;
+
+struct jaNodeList
+{
+	struct jaListNode* first;
+	struct jaListNode* last;
+	size_t nodes_no;
+};
+
+struct jaListNode
+{
+	struct jaNodeList* list;
+	struct jaListNode* next;
+	struct jaListNode* previous;
+};
+
+struct jaNodeListState
+{
+	struct jaListNode* start; // Set before iterate
+	bool reverse;             // Set before iterate
+
+	struct jaListNode* actual;
+	struct jaListNode* future_return;
+};
+
+#define JA_LIST_NODE_OWNER(node, type, member) ((type*)(void*)((char*)(node) - offsetof(type, member)))
+
+// Clean() frees everything, Clear() removes all items but pooled lists keep their
+// memory for the next ones, without a free() per item. Pooled items remain valid
+// once detached, until their list is cleaned or cleared
 JA_EXPORT void jaListClean(struct jaList* list);
+JA_EXPORT void jaListClear(struct jaList* list);
 
 JA_EXPORT struct jaListItem* jaListAdd(struct jaList* list, void* data, size_t data_size);
 JA_EXPORT struct jaListItem* jaListAddAfter(struct jaListItem* item, void* data, size_t data_size);
@@ -60,4 +114,16 @@ JA_EXPORT int jaListDetach(struct jaListItem* item);
 
 JA_EXPORT struct jaListItem* jaListIterate(struct jaListState* state);
 
+// Intrusive variant, nodes live inside user objects (JA_LIST_NODE_OWNER() goes back
+// to them) and are never allocated nor freed. Nodes start zeroed, and adding one
+// already in a list fails
+JA_EXPORT int jaNodeListAdd(struct jaNodeList* list, struct jaListNode* node);
+JA_EXPORT int jaNodeListAddAfter(struct jaListNode* node, struct jaListNode* new_node);
+JA_EXPORT int jaNodeListAddBefore(struct jaListNode* node, struct jaListNode* new_node);
+
+JA_EXPORT int jaNodeListRemove(struct jaListNode* node);
+JA_EXPORT struct jaListNode* jaNodeListPop(struct jaNodeList* list); // First node, removed
+
+JA_EXPORT struct jaListNode* jaNodeListIterate(struct jaNodeListState* state);
+
 #endif
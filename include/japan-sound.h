@@ -21,6 +21,8 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#include "japan-allocator.h"
+#include "japan-buffer.h"
 #include "japan-endianness.h"
 #include "japan-status.h"
 
@@ -49,6 +51,7 @@ struct jaSound
 
 	enum jaSoundFormat format;
 	void* data;
+	const struct jaAllocator* allocator; // Where the sound and its data came from
 };
 
 struct jaSoundEx
@@ -71,9 +74,14 @@ struct jaSoundEx
 };
 
 JA_EXPORT struct jaSound* jaSoundCreate(enum jaSoundFormat, size_t length, size_t channels, size_t frequency);
+JA_EXPORT struct jaSound* jaSoundCreateEx(enum jaSoundFormat, size_t length, size_t channels, size_t frequency,
+                                          enum jaBufferFlags); // Aligned or in huge pages data
+JA_EXPORT struct jaSound* jaSoundCreateWith(enum jaSoundFormat, size_t length, size_t channels, size_t frequency,
+                                            enum jaBufferFlags, const struct jaAllocator*);
 JA_EXPORT void jaSoundDelete(struct jaSound* sound);
 
 JA_EXPORT struct jaSound* jaSoundLoad(const char* filename, struct jaStatus*);
+JA_EXPORT struct jaSound* jaSoundLoadWith(const char* filename, const struct jaAllocator*, struct jaStatus*);
 JA_EXPORT int jaSoundSaveAu(const struct jaSound* sound, const char* filename, struct jaStatus*);
 JA_EXPORT int jaSoundSaveWav(const struct jaSound* sound, const char* filename, struct jaStatus*);
 JA_EXPORT int jaSoundSaveRaw(const struct jaSound* sound, const char* filename, struct jaStatus*);
@@ -20,6 +20,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "japan-buffer.h"
+
 enum jaEncode
 {
 	JA_ASCII,
@@ -33,4 +35,11 @@ JA_EXPORT size_t jaUnitLengthUTF8(uint8_t head_byte);
 JA_EXPORT int jaUnitValidateUTF8(const uint8_t* byte, size_t n, size_t* out_unit_len, uint32_t* out_unit_code);
 JA_EXPORT int jaStringValidateUTF8(const uint8_t* string, size_t n, size_t* out_bytes, size_t* out_units);
 
+// Views don't require a NULL terminator, all their bytes are validated. Trim()
+// removes spaces, tabs and line ends at both sides, and Split() returns what is
+// before 'delimiter', advancing 'string' after it (call it until it is empty)
+JA_EXPORT int jaStringValidateView(struct jaBufferView string, enum jaEncode, size_t* out_units);
+JA_EXPORT struct jaBufferView jaStringTrim(struct jaBufferView string);
+JA_EXPORT struct jaBufferView jaStringSplit(struct jaBufferView* string, uint8_t delimiter);
+
 #endif
@@ -17,11 +17,22 @@
 	#define JA_EXPORT // Whitespace
 #endif
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include "japan-allocator.h"
 #include "japan-buffer.h"
 
 #define JA_TREE_STACK_DEPTH 50
 
+enum jaTreePoolFlags
+{
+	JA_TREE_POOL_DEFAULT = 0,
+	JA_TREE_POOL_CALLBACKS = 1 // Deleting the root calls delete callbacks
+};
+
+struct jaTreePool; // Private
+
 struct jaTree
 {
 	struct jaTree* parent;
@@ -31,6 +42,8 @@ struct jaTree
 	struct jaTree* last_children;
 
 	void (*callback_delete)(struct jaTree*);
+	const struct jaAllocator* allocator;
+	struct jaTreePool* pool; // Private, if pooled
 
 	void* data;
 };
@@ -48,12 +61,98 @@ struct jaTreeState
 	struct jaTree* future_parent[JA_TREE_STACK_DEPTH];
 };
 
+// Stackless alternative to Iterate(), following parent pointers, so it needs
+// no buffer at any depth. The next node is found before returning the actual
+// one, this last can be deleted in post-order. Breadth-first walks again the
+// upper levels for every new one, O(nodes * height)
+enum jaTreeOrder
+{
+	JA_TREE_PRE_ORDER = 0,
+	JA_TREE_POST_ORDER,
+	JA_TREE_BREADTH_FIRST
+};
+
+struct jaTreeCursor
+{
+	struct jaTree* start;   // Set before iterate, with the rest zeroed
+	enum jaTreeOrder order; // "
+
+	struct jaTree* actual;
+	size_t depth; // From 'start'
+
+	struct jaTree* future_return;
+	size_t future_depth;
+	size_t level; // Breadth-first one
+};
+
+// Create() takes the allocator of 'parent', or malloc() if there is none
 JA_EXPORT struct jaTree* jaTreeCreate(struct jaTree* parent, void* data, size_t data_size);
+JA_EXPORT struct jaTree* jaTreeCreateWith(struct jaTree* parent, void* data, size_t data_size,
+                                          const struct jaAllocator* allocator);
 JA_EXPORT void jaTreeDelete(struct jaTree* tree);
 
+// A root with a pool, nodes created under it come from there (ignoring any other
+// allocator) and can't be attached out of it. Deleting the root frees all of
+// them at once, detached ones included, calling delete callbacks only with
+// JA_TREE_POOL_CALLBACKS, in creation order. Deleting other nodes returns them
+// to the pool
+JA_EXPORT struct jaTree* jaTreeCreatePool(void* data, size_t data_size, const struct jaAllocator* allocator,
+                                          enum jaTreePoolFlags flags);
+
 JA_EXPORT struct jaTree* jaTreeIterate(struct jaTreeState* state, struct jaBuffer* buffer);
+JA_EXPORT struct jaTree* jaTreeIterateNext(struct jaTreeCursor* cursor);
+
+// Parallel, 'workers_no' threads (the calling one included) stealing subtrees
+// between them. The callback gets the value of the parent of every node, to
+// accumulate into its own (of 'value_size'), as world transforms do. The root
+// gets 'value', or zeros. Pre-order within a worker, none between them
+JA_EXPORT int jaTreeIterateParallel(struct jaTree* tree, size_t workers_no,
+                                    void (*callback)(struct jaTree*, const void* parent_value, void* value,
+                                                     void* extra_data),
+                                    size_t value_size, const void* value, void* extra_data);
+
+// Allocators and delete callbacks are called from many threads, pooled trees are
+// deleted by the calling one
+JA_EXPORT void jaTreeDeleteParallel(struct jaTree* tree, size_t workers_no);
 
 JA_EXPORT int jaTreeAttach(struct jaTree* tree, struct jaTree* new_parent);
 JA_EXPORT int jaTreeDetach(struct jaTree* tree);
 
+// Flat variant, nodes and their data in two arrays, linked by indices (stable, unlike
+// pointers to them). Zeroed to start. While 'ordered' nodes are in depth-first order, parents first, so
+// 'for (i = 0; i < nodes_no; i++)' is a traversal. Adding nodes to the last branch
+// keeps it, other edits require a Compact() to recover it
+#define JA_FLAT_TREE_NONE UINT32_MAX
+#define JA_FLAT_TREE_REMOVED (UINT32_MAX - 1) // As parent, removed until compaction
+
+struct jaFlatTreeNode
+{
+	uint32_t parent;
+	uint32_t next;
+	uint32_t children;
+	uint32_t last_children;
+};
+
+struct jaFlatTree
+{
+	struct jaBuffer nodes; // Of 'struct jaFlatTreeNode', their flags and allocator can be set before adding nodes
+	struct jaBuffer data;  // "
+	size_t data_size;      // Of every node, set before adding them
+
+	size_t nodes_no; // Including removed ones
+	uint32_t first;  // Root, or the first of many
+	uint32_t last;
+	bool ordered;
+};
+
+JA_EXPORT uint32_t jaFlatTreeAdd(struct jaFlatTree* tree, uint32_t parent, const void* data); // NONE on failure
+JA_EXPORT int jaFlatTreeRemove(struct jaFlatTree* tree, uint32_t index);                     // With its children
+JA_EXPORT int jaFlatTreeCompact(struct jaFlatTree* tree);
+JA_EXPORT void jaFlatTreeClean(struct jaFlatTree* tree);
+
+JA_EXPORT struct jaFlatTreeNode* jaFlatTreeNode(const struct jaFlatTree* tree, uint32_t index);
+JA_EXPORT void* jaFlatTreeData(const struct jaFlatTree* tree, uint32_t index);
+// Depth-first, from NONE returns the first node and at the end NONE again
+JA_EXPORT uint32_t jaFlatTreeNext(const struct jaFlatTree* tree, uint32_t index);
+
 #endif
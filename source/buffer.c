@@ -28,21 +28,213 @@ SOFTWARE.
  - Alexander Brandt 2019-2020
 -----------------------------*/
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // For mremap()
+#endif
+
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 #include "common.h"
 #include "japan-buffer.h"
 
 
+#define DEFAULT_GROWTH 200 // Percentages
+#define MIN_GROWTH 110
+
+
+static inline size_t sGrown(const struct jaBuffer* buffer, size_t required)
+{
+	// Geometric, so appending a byte at a time costs O(1) amortized
+	size_t growth = (buffer->growth >= MIN_GROWTH) ? buffer->growth : DEFAULT_GROWTH;
+
+	if (required > SIZE_MAX / growth)
+		return required;
+
+	return (required * growth) / 100;
+}
+
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024) // Also the minimum size to map
+
+
+static inline size_t sAlignment(enum jaBufferFlags flags)
+{
+	if (flags & JA_BUFFER_ALIGN_64)
+		return 64;
+
+	return (flags & JA_BUFFER_ALIGN_32) ? 32 : 0;
+}
+
+
+static inline bool sMapped(const struct jaBuffer* buffer, size_t capacity)
+{
+	// Decided by the size, so always the same for a given buffer
+#if defined(__linux__)
+	return ((buffer->flags & JA_BUFFER_HUGE_PAGES) && capacity >= HUGE_PAGE_SIZE) ? true : false;
+#else
+	(void)buffer;
+	(void)capacity;
+	return false;
+#endif
+}
+
+
+#if defined(__linux__)
+static void* sMap(size_t size)
+{
+	// Mapped with an extra huge page, to trim it to an aligned start
+	uint8_t* data = NULL;
+	size_t head = 0;
+
+	if ((data = mmap(NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) ==
+	    MAP_FAILED)
+		return NULL;
+
+	head = (HUGE_PAGE_SIZE - ((uintptr_t)data % HUGE_PAGE_SIZE)) % HUGE_PAGE_SIZE;
+
+	if (head != 0)
+		munmap(data, head);
+
+	munmap(data + head + size, HUGE_PAGE_SIZE - head);
+
+#if defined(MADV_HUGEPAGE)
+	madvise(data + head, size, MADV_HUGEPAGE); // Just an advice, it may be disabled
+#endif
+
+	return data + head;
+}
+#endif
+
+
+static void* sAllocate(const struct jaBuffer* buffer, size_t* capacity)
+{
+	size_t alignment = sAlignment(buffer->flags);
+	void* data = NULL;
+
+#if defined(__linux__)
+	if (sMapped(buffer, *capacity))
+	{
+		*capacity = ((*capacity + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+		return sMap(*capacity);
+	}
+#endif
+
+	if (alignment == 0)
+		return Allocate(buffer->allocator, *capacity);
+
+	if (buffer->allocator != NULL)
+	{
+		// Allocated with room to align it, the offset kept in the byte before
+		uint8_t* raw = NULL;
+
+		if (*capacity > SIZE_MAX - alignment || (raw = Allocate(buffer->allocator, *capacity + alignment)) == NULL)
+			return NULL;
+
+		data = raw + alignment - ((uintptr_t)raw % alignment);
+		((uint8_t*)data)[-1] = (uint8_t)((uint8_t*)data - raw);
+		return data;
+	}
+
+#if defined(_WIN32)
+	data = _aligned_malloc(*capacity, alignment);
+#else
+	if (posix_memalign(&data, alignment, *capacity) != 0)
+		data = NULL;
+#endif
+
+	return data;
+}
+
+
+static void sFree(struct jaBuffer* buffer)
+{
+	if (buffer->data == NULL)
+		return;
+
+#if defined(__linux__)
+	if (sMapped(buffer, buffer->size))
+	{
+		munmap(buffer->data, buffer->size);
+		return;
+	}
+#endif
+
+	if (sAlignment(buffer->flags) != 0 && buffer->allocator != NULL)
+	{
+		Deallocate(buffer->allocator, (uint8_t*)buffer->data - ((uint8_t*)buffer->data)[-1]);
+		return;
+	}
+
+#if defined(_WIN32)
+	if (sAlignment(buffer->flags) != 0)
+	{
+		_aligned_free(buffer->data);
+		return;
+	}
+#endif
+
+	Deallocate(buffer->allocator, buffer->data);
+}
+
+
+static int sReallocate(struct jaBuffer* buffer, size_t capacity)
+{
+	void* data = NULL;
+
+	if (sAlignment(buffer->flags) == 0 && sMapped(buffer, buffer->size) == false && sMapped(buffer, capacity) == false)
+	{
+		if ((data = Reallocate(buffer->allocator, buffer->data, capacity)) == NULL)
+			return 1;
+	}
+#if defined(__linux__)
+	else if (sMapped(buffer, buffer->size) == true && sMapped(buffer, capacity) == true)
+	{
+		// Pages move without copying them
+		capacity = ((capacity + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+		data = buffer->data;
+
+		if (capacity != buffer->size &&
+		    (data = mremap(buffer->data, buffer->size, capacity, MREMAP_MAYMOVE)) == MAP_FAILED)
+			return 1;
+	}
+#endif
+	else
+	{
+		// No realloc() for the others, copy what fits
+		if ((data = sAllocate(buffer, &capacity)) == NULL)
+			return 1;
+
+		if (buffer->data != NULL)
+		{
+			memcpy(data, buffer->data, (buffer->size < capacity) ? buffer->size : capacity);
+			sFree(buffer);
+		}
+	}
+
+	buffer->data = data;
+	buffer->size = capacity;
+
+	if (buffer->length > capacity)
+		buffer->length = capacity;
+
+	return 0;
+}
+
+
 inline void jaBufferClean(struct jaBuffer* buffer)
 {
-	if (buffer->data != NULL)
-		free(buffer->data);
+	sFree(buffer);
 
 	buffer->data = NULL;
 	buffer->size = 0;
+	buffer->length = 0;
 }
 
 
@@ -58,25 +250,17 @@ int jaBufferCopy(struct jaBuffer* dest, const struct jaBuffer* org)
 	}
 
 	memcpy(dest->data, org->data, org->size);
+	dest->length = org->length;
 	return 0;
 }
 
 
 void* jaBufferResize(struct jaBuffer* buffer, size_t new_size)
 {
-	void* old_data = buffer->data;
-	size_t old_size = buffer->size;
-
 	if (new_size != 0 && (new_size > buffer->size || (new_size * 2) < (buffer->size / 2)))
 	{
-		buffer->size = new_size * 2;
-
-		if ((buffer->data = realloc(buffer->data, buffer->size)) == NULL)
-		{
-			buffer->data = old_data;
-			buffer->size = old_size;
+		if (sReallocate(buffer, sGrown(buffer, new_size)) != 0)
 			return NULL;
-		}
 	}
 
 	return buffer->data;
@@ -94,3 +278,129 @@ void* jaBufferResizeZero(struct jaBuffer* buffer, size_t new_size)
 
 	return buffer;
 }
+
+
+void* jaBufferReserve(struct jaBuffer* buffer, size_t capacity)
+{
+	if (capacity > buffer->size && sReallocate(buffer, capacity) != 0)
+		return NULL;
+
+	return buffer->data;
+}
+
+
+int jaBufferShrinkToFit(struct jaBuffer* buffer)
+{
+	if (buffer->length == 0)
+	{
+		sFree(buffer);
+		buffer->data = NULL;
+		buffer->size = 0;
+	}
+	else if (buffer->size > buffer->length)
+		return sReallocate(buffer, buffer->length); // A failure leaves it as it was
+
+	return 0;
+}
+
+
+inline void jaBufferClear(struct jaBuffer* buffer)
+{
+	buffer->length = 0;
+}
+
+
+void* jaBufferAppend(struct jaBuffer* buffer, const void* data, size_t n)
+{
+	uint8_t* dest = NULL;
+
+	if (n > SIZE_MAX - buffer->length)
+		return NULL;
+
+	if (buffer->length + n > buffer->size && sReallocate(buffer, sGrown(buffer, buffer->length + n)) != 0)
+		return NULL;
+
+	dest = (uint8_t*)buffer->data + buffer->length;
+	buffer->length += n;
+
+	if (data != NULL)
+		memcpy(dest, data, n);
+
+	return dest;
+}
+
+
+int jaBufferAppendByte(struct jaBuffer* buffer, uint8_t byte)
+{
+	if (buffer->length == buffer->size && sReallocate(buffer, sGrown(buffer, buffer->length + 1)) != 0)
+		return 1;
+
+	((uint8_t*)buffer->data)[buffer->length] = byte;
+	buffer->length += 1;
+	return 0;
+}
+
+
+inline struct jaBufferView jaBufferViewOf(const void* data, size_t size)
+{
+	struct jaBufferView view = {data, (data != NULL) ? size : 0};
+	return view;
+}
+
+
+inline struct jaBufferView jaBufferViewString(const char* string)
+{
+	return jaBufferViewOf(string, (string != NULL) ? strlen(string) : 0);
+}
+
+
+struct jaBufferView jaBufferViewSlice(struct jaBufferView view, size_t offset, size_t size)
+{
+	if (offset > view.size)
+		offset = view.size;
+
+	if (size > view.size - offset)
+		size = view.size - offset;
+
+	return jaBufferViewOf((view.data != NULL) ? ((const uint8_t*)view.data + offset) : NULL, size);
+}
+
+
+size_t jaBufferViewFind(struct jaBufferView view, uint8_t byte)
+{
+	const uint8_t* found = NULL;
+
+	if (view.size == 0 || (found = memchr(view.data, byte, view.size)) == NULL)
+		return view.size;
+
+	return (size_t)(found - (const uint8_t*)view.data);
+}
+
+
+int jaBufferViewEqual(struct jaBufferView a, struct jaBufferView b)
+{
+	if (a.size != b.size)
+		return 0;
+
+	return (a.size == 0 || memcmp(a.data, b.data, a.size) == 0) ? 1 : 0;
+}
+
+
+int jaBufferCopyView(struct jaBuffer* dest, struct jaBufferView org)
+{
+	if (org.size == 0)
+	{
+		dest->length = 0;
+		return 0;
+	}
+
+	if (dest->size < org.size)
+	{
+		if (jaBufferResize(dest, org.size) == NULL)
+			return 1;
+	}
+
+	memcpy(dest->data, org.data, org.size);
+	dest->length = org.size;
+	return 0;
+}
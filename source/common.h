@@ -7,6 +7,11 @@
 #ifndef JA_COMMON_H
 #define JA_COMMON_H
 
+	#include <stdlib.h>
+	#include <string.h>
+
+	#include "japan-allocator.h"
+
 	#ifdef JA_DEBUG
 		#include <stdio.h>
 		#define JA_DEBUG_PRINT(...) printf(__VA_ARGS__)
@@ -14,4 +19,35 @@
 		#define JA_DEBUG_PRINT(...)
 	#endif
 
+	static inline void* Allocate(const struct jaAllocator* allocator, size_t size)
+	{
+		return (allocator == NULL) ? malloc(size) : allocator->allocate(size, allocator->context);
+	}
+
+	static inline void* AllocateZero(const struct jaAllocator* allocator, size_t size)
+	{
+		void* ptr = NULL;
+
+		if (allocator == NULL)
+			return calloc(1, size);
+
+		if ((ptr = allocator->allocate(size, allocator->context)) != NULL)
+			memset(ptr, 0, size);
+
+		return ptr;
+	}
+
+	static inline void* Reallocate(const struct jaAllocator* allocator, void* ptr, size_t size)
+	{
+		return (allocator == NULL) ? realloc(ptr, size) : allocator->reallocate(ptr, size, allocator->context);
+	}
+
+	static inline void Deallocate(const struct jaAllocator* allocator, void* ptr)
+	{
+		if (allocator == NULL)
+			free(ptr);
+		else if (ptr != NULL)
+			allocator->deallocate(ptr, allocator->context);
+	}
+
 #endif
@@ -31,28 +31,32 @@ SOFTWARE.
 #include "private.h"
 
 
-static inline void sTrimWhitespaces(const char* string, char* output)
+static inline struct jaBufferView sKey(const char* argument)
 {
-	bool body_reached = false;
-	char* o = output;
+	// First word, without copying it from the argument
+	struct jaBufferView key = jaStringTrim(jaBufferViewString(argument));
+	size_t i = 0;
 
-	for (; *string != 0x00 && (o - output) < JA_CVAR_KEY_MAX_LEN; string++)
-	{
-		if (*string != 0x20 && *string != 0x09) // SPACE, TAB
-		{
-			body_reached = true;
+	while (i < key.size && i < (JA_CVAR_KEY_MAX_LEN - 1) && ((const char*)key.data)[i] != 0x20 &&
+	       ((const char*)key.data)[i] != 0x09) // SPACE, TAB
+		i++;
 
-			*o = *string;
-			o += 1;
-		}
-		else
-		{
-			if (body_reached == true)
-				break;
-		}
-	}
+	return jaBufferViewSlice(key, 0, i);
+}
+
+
+static void sWarning(void (*warnings_callback)(enum jaStatusCode, int, const char*, const char*),
+                     enum jaStatusCode code, int i, struct jaBufferView key, const char* value)
+{
+	// Callbacks receive NULL terminated strings, only copied here
+	char terminated_key[JA_CVAR_KEY_MAX_LEN];
 
-	*o = 0x00;
+	if (warnings_callback != NULL)
+	{
+		memcpy(terminated_key, key.data, key.size);
+		terminated_key[key.size] = 0x00;
+		warnings_callback(code, i, terminated_key, value);
+	}
 }
 
 
@@ -67,35 +71,31 @@ void jaConfigurationArgumentsEx(struct jaConfiguration* config, enum jaEncode en
                                 const char* argv[])
 {
 	struct jaDictionaryItem* item = NULL;
-	char trimmed_key[JA_CVAR_KEY_MAX_LEN];
+	struct jaBufferView key;
 
 	for (int i = (flags == JA_PARSE_FIRST) ? 0 : 1; i < argc; i++)
 	{
 		// Check key
-		sTrimWhitespaces(argv[i], trimmed_key);
+		key = sKey(argv[i]);
 
-		if (trimmed_key[0] != 0x2D) // HYPHEN
+		if (key.size == 0 || ((const char*)key.data)[0] != 0x2D) // HYPHEN
 		{
-			if (warnings_callback != NULL)
-				warnings_callback(JA_STATUS_INVALID_KEY_TOKEN, i, trimmed_key, NULL);
-
+			sWarning(warnings_callback, JA_STATUS_INVALID_KEY_TOKEN, i, key, NULL);
 			continue;
 		}
 
-		if ((item = jaDictionaryGet((struct jaDictionary*)config, (trimmed_key + 1))) == NULL)
-		{
-			if (warnings_callback != NULL)
-				warnings_callback(JA_STATUS_EXPECTED_KEY_TOKEN, i, trimmed_key + 1, NULL);
+		key = jaBufferViewSlice(key, 1, key.size);
 
+		if (config == NULL || (item = jaDictionaryGetN(config->dictionary, key.data, key.size)) == NULL)
+		{
+			sWarning(warnings_callback, JA_STATUS_EXPECTED_KEY_TOKEN, i, key, NULL);
 			continue;
 		}
 
 		// Retrieve value
 		if ((i + 1) == argc)
 		{
-			if (warnings_callback != NULL)
-				warnings_callback(JA_STATUS_NO_ASSIGNMENT, i, trimmed_key + 1, NULL);
-
+			sWarning(warnings_callback, JA_STATUS_NO_ASSIGNMENT, i, key, NULL);
 			break;
 		}
 
@@ -104,9 +104,7 @@ void jaConfigurationArgumentsEx(struct jaConfiguration* config, enum jaEncode en
 		{
 			if (jaStringValidateUTF8((uint8_t*)argv[i + 1], UINT_MAX, NULL, NULL) != 0)
 			{
-				if (warnings_callback != NULL)
-					warnings_callback(JA_STATUS_UTF8_ERROR, i, trimmed_key + 1, argv[i + 1]);
-
+				sWarning(warnings_callback, JA_STATUS_UTF8_ERROR, i, key, argv[i + 1]);
 				continue;
 				i++; // Important!
 			}
@@ -115,9 +113,7 @@ void jaConfigurationArgumentsEx(struct jaConfiguration* config, enum jaEncode en
 		{
 			if (jaStringValidateASCII((uint8_t*)argv[i + 1], UINT_MAX, NULL) != 0)
 			{
-				if (warnings_callback != NULL)
-					warnings_callback(JA_STATUS_ASCII_ERROR, i, trimmed_key + 1, argv[i + 1]);
-
+				sWarning(warnings_callback, JA_STATUS_ASCII_ERROR, i, key, argv[i + 1]);
 				continue;
 				i++; // Important!
 			}
@@ -127,10 +123,7 @@ void jaConfigurationArgumentsEx(struct jaConfiguration* config, enum jaEncode en
 		enum jaStatusCode code = Store(item->data, argv[i + 1], SET_BY_ARGUMENTS);
 
 		if (code != JA_STATUS_SUCCESS)
-		{
-			if (warnings_callback != NULL)
-				warnings_callback(code, i, trimmed_key + 1, argv[i + 1]);
-		}
+			sWarning(warnings_callback, code, i, key, argv[i + 1]);
 
 		i++; // Important!
 	}
@@ -54,13 +54,36 @@ static inline const char* sBufferGetString(const struct jaBuffer* b)
 
 inline struct jaConfiguration* jaConfigurationCreate()
 {
-	return (struct jaConfiguration*)jaDictionaryCreate(NULL);
+	return jaConfigurationCreateWith(NULL);
+}
+
+
+inline struct jaConfiguration* jaConfigurationCreateWith(const struct jaAllocator* allocator)
+{
+	struct jaConfiguration* config = NULL;
+
+	if ((config = Allocate(allocator, sizeof(struct jaConfiguration))) == NULL)
+		return NULL;
+
+	// Keys may come from arguments and files
+	if ((config->dictionary = jaDictionaryCreateWith(NULL, JA_DICTIONARY_SEEDED, 0, allocator)) == NULL)
+	{
+		Deallocate(allocator, config);
+		return NULL;
+	}
+
+	config->allocator = allocator;
+	return config;
 }
 
 
 inline void jaConfigurationDelete(struct jaConfiguration* config)
 {
-	jaDictionaryDelete((struct jaDictionary*)config);
+	if (config != NULL)
+	{
+		jaDictionaryDelete(config->dictionary);
+		Deallocate(config->allocator, config);
+	}
 }
 
 
@@ -125,13 +148,19 @@ static struct jaCvar* sCvarCreate(struct jaConfiguration* config, const char* ke
 
 	jaStatusSet(st, "jaCvarCreate", JA_STATUS_SUCCESS, NULL);
 
+	if (config == NULL)
+	{
+		jaStatusSet(st, "jaCvarCreate", JA_STATUS_INVALID_ARGUMENT, NULL);
+		return NULL;
+	}
+
 	if (key == NULL || sValidateKey(key) != 0)
 	{
 		jaStatusSet(st, "jaCvarCreate", JA_STATUS_INVALID_ARGUMENT, "Invalid key");
 		return NULL;
 	}
 
-	if ((item = jaDictionaryAdd((struct jaDictionary*)config, key, NULL, sizeof(struct jaCvar))) == NULL)
+	if ((item = jaDictionaryAdd(config->dictionary, key, NULL, sizeof(struct jaCvar))) == NULL)
 	{
 		jaStatusSet(st, "jaCvarCreate", JA_STATUS_MEMORY_ERROR, NULL);
 		return NULL;
@@ -143,6 +172,7 @@ static struct jaCvar* sCvarCreate(struct jaConfiguration* config, const char* ke
 	memset(cvar, 0, sizeof(struct jaCvar));
 	cvar->type = type;
 	cvar->item = item;
+	cvar->value.s.allocator = config->allocator;
 
 	return cvar;
 }
@@ -281,7 +311,22 @@ struct jaCvar* jaCvarCreateString(struct jaConfiguration* config, const char* na
 
 inline struct jaCvar* jaCvarGet(const struct jaConfiguration* config, const char* key)
 {
-	struct jaDictionaryItem* item = jaDictionaryGet((struct jaDictionary*)config, key);
+	struct jaDictionaryItem* item = NULL;
+
+	if (config != NULL)
+		item = jaDictionaryGet(config->dictionary, key);
+
+	return (item != NULL) ? (struct jaCvar*)item->data : NULL;
+}
+
+
+inline struct jaCvar* jaCvarGetView(const struct jaConfiguration* config, struct jaBufferView key)
+{
+	struct jaDictionaryItem* item = NULL;
+
+	if (config != NULL)
+		item = jaDictionaryGetN(config->dictionary, key.data, key.size);
+
 	return (item != NULL) ? (struct jaCvar*)item->data : NULL;
 }
 
@@ -359,3 +404,15 @@ int jaCvarGetValueString(const struct jaCvar* cvar, const char** dest, struct ja
 	*dest = sBufferGetString(&cvar->value.s);
 	return 0;
 }
+
+
+int jaCvarGetValueView(const struct jaCvar* cvar, struct jaBufferView* dest, struct jaStatus* st)
+{
+	const char* string = NULL;
+
+	if (jaCvarGetValueString(cvar, &string, st) != 0)
+		return 1;
+
+	*dest = jaBufferViewString(string); // Valid until the cvar changes
+	return 0;
+}
@@ -19,6 +19,8 @@
 	#include "japan-dictionary.h"
 	#include "japan-utilities.h"
 
+	#include "../common.h"
+
 	enum Type
 	{
 		TYPE_INT = 0,
@@ -40,6 +42,12 @@
 		struct jaBuffer s;
 	};
 
+	struct jaConfiguration
+	{
+		struct jaDictionary* dictionary;
+		const struct jaAllocator* allocator; // Also for string values
+	};
+
 	struct jaCvar
 	{
 		struct jaDictionaryItem* item;
@@ -0,0 +1,147 @@
+/*-----------------------------
+
+MIT License
+
+Copyright (c) 2019 Alexander Brandt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-------------------------------
+
+ [arena.c]
+ - Alexander Brandt 2020
+
+ Chunked bump allocator, nothing is freed until ArenaDelete()
+-----------------------------*/
+
+#include "private.h"
+
+
+#define ALIGNMENT 16
+
+#define INITIAL_CHUNK_SIZE 4096
+#define MAX_CHUNK_SIZE (1024 * 1024) // Chunks double their size up to this
+
+struct ArenaChunk
+{
+	struct ArenaChunk* previous;
+	size_t size;
+	size_t used;
+};
+
+
+/*-----------------------------
+
+ sAlign()
+-----------------------------*/
+static inline size_t sAlign(size_t value)
+{
+	return (value + (ALIGNMENT - 1)) & ~((size_t)ALIGNMENT - 1);
+}
+
+
+/*-----------------------------
+
+ sNewChunk()
+-----------------------------*/
+static struct ArenaChunk* sNewChunk(const struct jaAllocator* allocator, size_t size)
+{
+	struct ArenaChunk* chunk = NULL;
+
+	if ((chunk = Allocate(allocator, sAlign(sizeof(struct ArenaChunk)) + size)) != NULL)
+	{
+		chunk->previous = NULL;
+		chunk->size = size;
+		chunk->used = 0;
+	}
+
+	return chunk;
+}
+
+
+/*-----------------------------
+
+ ArenaAlloc()
+-----------------------------*/
+void* ArenaAlloc(struct Arena* arena, size_t size)
+{
+	struct ArenaChunk* chunk = arena->last;
+	void* ptr = NULL;
+
+	size = sAlign(size);
+
+	if (chunk == NULL || (chunk->size - chunk->used) < size)
+	{
+		size_t chunk_size = (arena->chunk_size == 0) ? INITIAL_CHUNK_SIZE : arena->chunk_size;
+
+		if (size > chunk_size)
+		{
+			// A dedicated chunk, behind the current one to keep using its space
+			if ((chunk = sNewChunk(arena->allocator, size)) == NULL)
+				return NULL;
+
+			if (arena->last == NULL)
+				arena->last = chunk;
+			else
+			{
+				chunk->previous = arena->last->previous;
+				arena->last->previous = chunk;
+			}
+		}
+		else
+		{
+			if ((chunk = sNewChunk(arena->allocator, chunk_size)) == NULL)
+				return NULL;
+
+			chunk->previous = arena->last;
+			arena->last = chunk;
+
+			if (chunk_size < MAX_CHUNK_SIZE)
+				arena->chunk_size = chunk_size * 2;
+			else
+				arena->chunk_size = chunk_size;
+		}
+	}
+
+	ptr = (uint8_t*)chunk + sAlign(sizeof(struct ArenaChunk)) + chunk->used;
+	chunk->used += size;
+
+	return ptr;
+}
+
+
+/*-----------------------------
+
+ ArenaDelete()
+-----------------------------*/
+void ArenaDelete(struct Arena* arena)
+{
+	struct ArenaChunk* chunk = arena->last;
+	struct ArenaChunk* previous = NULL;
+
+	while (chunk != NULL)
+	{
+		previous = chunk->previous;
+		Deallocate(arena->allocator, chunk);
+		chunk = previous;
+	}
+
+	arena->last = NULL;
+	arena->chunk_size = 0;
+}
@@ -0,0 +1,223 @@
+/*-----------------------------
+
+MIT License
+
+Copyright (c) 2019 Alexander Brandt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-------------------------------
+
+ [concurrent.c]
+ - Alexander Brandt 2020
+
+ Epoch based reclamation. Readers announce themselves in a counter
+ of the current epoch parity, writers advance the epoch and wait
+ for the counters of the previous parity to reach zero, at that
+ point nobody is able to hold what was unlinked before.
+
+ http://www.rdrop.com/~paulmck/RCU/
+ https://www.cl.cam.ac.uk/techreports/UCAM-CL-TR-579.pdf
+-----------------------------*/
+
+#include "private.h"
+
+
+static THREAD_LOCAL size_t s_stripe = 0; // Zero if not assigned
+static size_t s_threads_no = 0;
+
+
+/*-----------------------------
+
+ sStripe()
+-----------------------------*/
+static inline size_t sStripe()
+{
+	if (s_stripe == 0)
+		s_stripe = AtomicAddSize(&s_threads_no, 1);
+
+	return s_stripe % READER_STRIPES;
+}
+
+
+/*-----------------------------
+
+ sSynchronize()
+-----------------------------*/
+static void sSynchronize(struct Concurrent* concurrent)
+{
+	size_t parity = AtomicLoadSize(&concurrent->epoch) & 1;
+
+	// New readers will announce themselves in the other parity
+	AtomicAddSize(&concurrent->epoch, 1);
+
+	for (size_t i = 0; i < READER_STRIPES; i++)
+	{
+		while (AtomicLoadSize(&concurrent->reader[i].counter[parity]) != 0)
+			ThreadYield();
+	}
+}
+
+
+/*-----------------------------
+
+ sDispose()
+-----------------------------*/
+static void sDispose(struct jaDictionary* dictionary)
+{
+	struct Concurrent* concurrent = dictionary->concurrent;
+	struct Slots* next = NULL;
+
+	for (size_t i = 0; i < concurrent->retired_items_no; i++)
+	{
+		if (concurrent->retired_item[i]->callback_delete != NULL)
+			concurrent->retired_item[i]->callback_delete(concurrent->retired_item[i]);
+
+		if ((dictionary->flags & JA_DICTIONARY_ARENA) == 0)
+			Deallocate(dictionary->allocator, concurrent->retired_item[i]);
+	}
+
+	for (struct Slots* slots = concurrent->retired_slots; slots != NULL; slots = next)
+	{
+		next = slots->retired_next;
+		Deallocate(dictionary->allocator, slots);
+	}
+
+	concurrent->retired_items_no = 0;
+	concurrent->retired_slots = NULL;
+}
+
+
+/*-----------------------------
+
+ ConcurrentInit()
+-----------------------------*/
+int ConcurrentInit(struct jaDictionary* dictionary)
+{
+	if ((dictionary->concurrent = AllocateZero(dictionary->allocator, sizeof(struct Concurrent))) == NULL)
+		return 1;
+
+	if (MutexInit(&dictionary->concurrent->writer) != 0)
+	{
+		Deallocate(dictionary->allocator, dictionary->concurrent);
+		dictionary->concurrent = NULL;
+		return 1;
+	}
+
+	dictionary->lock = &dictionary->concurrent->writer;
+	return 0;
+}
+
+
+/*-----------------------------
+
+ ConcurrentDelete()
+-----------------------------*/
+void ConcurrentDelete(struct jaDictionary* dictionary)
+{
+	// No readers at this point
+	sDispose(dictionary);
+
+	MutexDestroy(&dictionary->concurrent->writer);
+	Deallocate(dictionary->allocator, dictionary->concurrent);
+	dictionary->concurrent = NULL;
+	dictionary->lock = NULL;
+}
+
+
+/*-----------------------------
+
+ RetireItem()
+-----------------------------*/
+void RetireItem(struct jaDictionary* dictionary, struct jaDictionaryItem* item)
+{
+	struct Concurrent* concurrent = dictionary->concurrent;
+
+	if (concurrent->retired_items_no == RETIRED_ITEMS_MAX)
+		Reclaim(dictionary);
+
+	concurrent->retired_item[concurrent->retired_items_no] = item;
+	concurrent->retired_items_no += 1;
+}
+
+
+/*-----------------------------
+
+ RetireSlots()
+-----------------------------*/
+void RetireSlots(struct jaDictionary* dictionary, struct Slots* slots)
+{
+	slots->retired_next = dictionary->concurrent->retired_slots;
+	dictionary->concurrent->retired_slots = slots;
+
+	// Too much memory to keep around
+	Reclaim(dictionary);
+}
+
+
+/*-----------------------------
+
+ Reclaim()
+-----------------------------*/
+void Reclaim(struct jaDictionary* dictionary)
+{
+	sSynchronize(dictionary->concurrent);
+	sDispose(dictionary);
+}
+
+
+/*-----------------------------
+
+ jaDictionaryReadBegin()
+-----------------------------*/
+size_t jaDictionaryReadBegin(struct jaDictionary* dictionary)
+{
+	struct Concurrent* concurrent = NULL;
+	size_t stripe = sStripe();
+	size_t epoch = 0;
+
+	if (dictionary == NULL || (concurrent = dictionary->concurrent) == NULL)
+		return 0;
+
+	// If the epoch changed meanwhile, the writer may had already
+	// checked our counter, so we need to try in the new parity
+	while (1)
+	{
+		epoch = AtomicLoadSize(&concurrent->epoch);
+		AtomicAddSize(&concurrent->reader[stripe].counter[epoch & 1], 1);
+
+		if (AtomicLoadSize(&concurrent->epoch) == epoch)
+			break;
+
+		AtomicAddSize(&concurrent->reader[stripe].counter[epoch & 1], SIZE_MAX); // Minus one
+	}
+
+	return (stripe << 1) | (epoch & 1);
+}
+
+
+/*-----------------------------
+
+ jaDictionaryReadEnd()
+-----------------------------*/
+void jaDictionaryReadEnd(struct jaDictionary* dictionary, size_t token)
+{
+	if (dictionary != NULL && dictionary->concurrent != NULL)
+		AtomicAddSize(&dictionary->concurrent->reader[token >> 1].counter[token & 1], SIZE_MAX);
+}
@@ -0,0 +1,687 @@
+/*-----------------------------
+
+MIT License
+
+Copyright (c) 2019 Alexander Brandt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-------------------------------
+
+ [dictionary.c]
+ - Alexander Brandt 2019-2020
+-----------------------------*/
+
+#include "private.h"
+
+
+#define DEFAULT_SHARDS 16
+
+
+/*-----------------------------
+
+ jaDictionaryCreate()
+-----------------------------*/
+inline struct jaDictionary* jaDictionaryCreate(uint64_t (*hash_function)(const char*, size_t))
+{
+	return jaDictionaryCreateEx(hash_function, JA_DICTIONARY_DEFAULT);
+}
+
+
+/*-----------------------------
+
+ jaDictionaryCreateEx()
+-----------------------------*/
+inline struct jaDictionary* jaDictionaryCreateEx(uint64_t (*hash_function)(const char*, size_t),
+                                                 enum jaDictionaryFlags flags)
+{
+	return jaDictionaryCreateSharded(hash_function, flags, DEFAULT_SHARDS);
+}
+
+
+/*-----------------------------
+
+ jaDictionaryCreateSharded()
+-----------------------------*/
+inline struct jaDictionary* jaDictionaryCreateSharded(uint64_t (*hash_function)(const char*, size_t),
+                                                      enum jaDictionaryFlags flags, size_t shards_no)
+{
+	return jaDictionaryCreateWith(hash_function, flags, shards_no, NULL);
+}
+
+
+/*-----------------------------
+
+ jaDictionaryCreateWith()
+-----------------------------*/
+struct jaDictionary* jaDictionaryCreateWith(uint64_t (*hash_function)(const char*, size_t),
+                                            enum jaDictionaryFlags flags, size_t shards_no,
+                                            const struct jaAllocator* allocator)
+{
+	struct jaDictionary* dictionary = NULL;
+	int error = 0;
+
+	if ((flags & JA_DICTIONARY_SHARDED) && (flags & JA_DICTIONARY_CONCURRENT))
+		return NULL;
+
+	if (flags & JA_DICTIONARY_CONCURRENT)
+		flags |= JA_DICTIONARY_OPEN_ADDRESSING;
+
+	if ((dictionary = AllocateZero(allocator, sizeof(struct jaDictionary))) != NULL)
+	{
+		dictionary->allocator = allocator;
+		dictionary->arena.allocator = allocator;
+		dictionary->flags = flags;
+		dictionary->hash_function = hash_function;
+
+		if (hash_function == NULL)
+			dictionary->hash_function = (flags & JA_DICTIONARY_WYHASH) ? jaWyHash : jaFNV1Hash;
+
+		if (flags & JA_DICTIONARY_SEEDED)
+			RandomSeed(dictionary->seed);
+
+		if (flags & JA_DICTIONARY_SHARDED)
+			error = ShardedInit(dictionary, shards_no);
+		else if (flags & JA_DICTIONARY_OPEN_ADDRESSING)
+			error = OpenAddressingInit(dictionary);
+		else
+			error = LinearHashingInit(dictionary);
+
+		if (error == 0 && (flags & JA_DICTIONARY_CONCURRENT) && ConcurrentInit(dictionary) != 0)
+		{
+			OpenAddressingDelete(dictionary);
+			error = 1;
+		}
+
+		if (error != 0)
+		{
+			Deallocate(allocator, dictionary);
+			dictionary = NULL;
+		}
+	}
+
+	return dictionary;
+}
+
+
+/*-----------------------------
+
+ jaDictionaryDelete()
+-----------------------------*/
+void jaDictionaryDelete(struct jaDictionary* dictionary)
+{
+	if (dictionary != NULL)
+	{
+		if (dictionary->sharded != NULL)
+			ShardedDelete(dictionary); // Shards have their own arenas
+		else if (dictionary->flags & JA_DICTIONARY_OPEN_ADDRESSING)
+			OpenAddressingDelete(dictionary);
+		else
+			LinearHashingDelete(dictionary);
+
+		if (dictionary->concurrent != NULL)
+			ConcurrentDelete(dictionary);
+
+		if (dictionary->flags & JA_DICTIONARY_ARENA)
+			ArenaDelete(&dictionary->arena);
+
+		Deallocate(dictionary->allocator, dictionary);
+	}
+}
+
+
+/*-----------------------------
+
+ jaDictionaryAdd()
+-----------------------------*/
+inline struct jaDictionaryItem* jaDictionaryAdd(struct jaDictionary* dictionary, const char* key, void* data,
+                                                size_t data_size)
+{
+	if (key == NULL)
+		return NULL;
+
+	return jaDictionaryAddN(dictionary, key, strlen(key), data, data_size);
+}
+
+
+/*-----------------------------
+
+ jaDictionaryGet()
+-----------------------------*/
+inline struct jaDictionaryItem* jaDictionaryGet(const struct jaDictionary* dictionary, const char* key)
+{
+	if (key == NULL)
+		return NULL;
+
+	return jaDictionaryGetN(dictionary, key, strlen(key));
+}
+
+
+/*-----------------------------
+
+ jaDictionaryAddN()
+-----------------------------*/
+struct jaDictionaryItem* jaDictionaryAddN(struct jaDictionary* dictionary, const char* key, size_t key_size,
+                                          void* data, size_t data_size)
+{
+	struct jaDictionaryItem* item = NULL;
+	uint64_t hash = 0;
+	size_t size = 0;
+	int error = 0;
+
+	if (dictionary == NULL || key == NULL)
+		return NULL;
+
+	hash = Hash(dictionary, key, key_size);
+
+	if (dictionary->sharded != NULL)
+		dictionary = ShardOf(dictionary, hash);
+
+	// Keys are stored NULL terminated, even if the user ones aren't
+	size = sizeof(struct jaDictionaryItem) + key_size + 1 + data_size;
+
+	if (dictionary->flags & JA_DICTIONARY_ARENA)
+	{
+		WriterLock(dictionary);
+		item = ArenaAlloc(&dictionary->arena, size);
+		WriterUnlock(dictionary);
+	}
+	else
+		item = Allocate(dictionary->allocator, size);
+
+	if (item == NULL)
+		return NULL;
+
+	item->dictionary = dictionary;
+	item->callback_delete = NULL;
+	item->hash = hash;
+	item->key_size = key_size;
+
+	memcpy(item->key, key, key_size);
+	item->key[key_size] = 0x00;
+
+	if (data_size == 0)
+		item->data = data;
+	else
+	{
+		item->data = (void*)((struct jaDictionaryItem*)item + 1);
+		item->data = (void*)((uint8_t*)item->data + key_size + 1);
+
+		if (data != NULL)
+			memcpy(item->data, data, data_size);
+	}
+
+	// Add to the table
+	WriterLock(dictionary);
+
+	if (dictionary->flags & JA_DICTIONARY_OPEN_ADDRESSING)
+		error = OpenAddressingAdd(dictionary, item);
+	else
+		error = LinearHashingAdd(dictionary, item);
+
+	WriterUnlock(dictionary);
+
+	if (error != 0)
+	{
+		if ((dictionary->flags & JA_DICTIONARY_ARENA) == 0)
+			Deallocate(dictionary->allocator, item); // Otherwise wasted until jaDictionaryDelete()
+
+		return NULL;
+	}
+
+	return item;
+}
+
+
+/*-----------------------------
+
+ sGet()
+-----------------------------*/
+static inline struct jaDictionaryItem* sGet(const struct jaDictionary* dictionary, const char* key, size_t key_size,
+                                            uint64_t hash)
+{
+	if (dictionary->flags & JA_DICTIONARY_OPEN_ADDRESSING)
+		return OpenAddressingGet(dictionary, key, key_size, hash);
+
+	return LinearHashingGet(dictionary, key, key_size, hash);
+}
+
+
+/*-----------------------------
+
+ jaDictionaryGetN()
+-----------------------------*/
+struct jaDictionaryItem* jaDictionaryGetN(const struct jaDictionary* dictionary, const char* key, size_t key_size)
+{
+	struct jaDictionaryItem* item = NULL;
+	struct jaDictionary* shard = NULL;
+	uint64_t hash = 0;
+
+	if (dictionary == NULL || key == NULL)
+		return NULL;
+
+	hash = Hash(dictionary, key, key_size);
+
+	if (dictionary->sharded == NULL)
+		return sGet(dictionary, key, key_size, hash);
+
+	// Unlike concurrent tables, shards are resized in place by writers
+	shard = ShardOf(dictionary, hash);
+
+	MutexLock(shard->lock);
+	item = sGet(shard, key, key_size, hash);
+	MutexUnlock(shard->lock);
+
+	return item;
+}
+
+
+/*-----------------------------
+
+ jaDictionaryReserve()
+-----------------------------*/
+int jaDictionaryReserve(struct jaDictionary* dictionary, size_t items_no)
+{
+	int error = 0;
+
+	if (dictionary == NULL)
+		return 1;
+
+	if (dictionary->sharded != NULL)
+		return ShardedReserve(dictionary, items_no);
+
+	WriterLock(dictionary);
+
+	if (dictionary->flags & JA_DICTIONARY_OPEN_ADDRESSING)
+		error = OpenAddressingReserve(dictionary, items_no);
+	else
+		error = LinearHashingReserve(dictionary, items_no);
+
+	WriterUnlock(dictionary);
+	return error;
+}
+
+
+/*-----------------------------
+
+ jaDictionaryAddBatch()
+-----------------------------*/
+int jaDictionaryAddBatch(struct jaDictionary* dictionary, size_t items_no, const char* const* keys,
+                         void* const* data, size_t data_size)
+{
+	size_t current_items_no = 0;
+
+	if (dictionary == NULL || keys == NULL)
+		return 1;
+
+	current_items_no = (dictionary->sharded != NULL) ? ShardedItemsNo(dictionary) : dictionary->items_no;
+
+	// A failed reservation only means that the table grows as items are added
+	jaDictionaryReserve(dictionary, current_items_no + items_no);
+
+	for (size_t i = 0; i < items_no; i++)
+	{
+		// On failure, previous items remain added
+		if (jaDictionaryAdd(dictionary, keys[i], (data != NULL) ? data[i] : NULL, data_size) == NULL)
+			return 1;
+	}
+
+	return 0;
+}
+
+
+/*-----------------------------
+
+ jaDictionarySetThresholds()
+-----------------------------*/
+int jaDictionarySetThresholds(struct jaDictionary* dictionary, unsigned grow, unsigned shrink)
+{
+	if (dictionary == NULL || grow < 10 || grow > 95)
+		return 1;
+
+	// A band between both, so additions and removals around one threshold
+	// don't resize back and forth. Open addressing halves the table at once
+	if (shrink >= grow || ((dictionary->flags & JA_DICTIONARY_OPEN_ADDRESSING) && shrink * 2 >= grow))
+		return 1;
+
+	if (dictionary->sharded != NULL)
+	{
+		ShardedSetThresholds(dictionary, grow, shrink);
+		return 0;
+	}
+
+	WriterLock(dictionary);
+	dictionary->grow_threshold = grow;
+	dictionary->shrink_threshold = shrink;
+	WriterUnlock(dictionary);
+
+	return 0;
+}
+
+
+/*-----------------------------
+
+ AddStats()
+-----------------------------*/
+void AddStats(struct jaDictionary* dictionary, struct jaDictionaryStats* out)
+{
+	// Caller holds the writer lock, lookups still may happen
+	if (dictionary->flags & JA_DICTIONARY_OPEN_ADDRESSING)
+		OpenAddressingStats(dictionary, out);
+	else
+		LinearHashingStats(dictionary, out);
+
+	out->lookups_no += AtomicLoadSize(&dictionary->lookups_no);
+	out->probes_no += AtomicLoadSize(&dictionary->probes_no);
+	out->resizes_no += dictionary->resizes_no;
+	out->resizes_ns += dictionary->resizes_ns;
+
+	if (dictionary->resize_max_ns > out->resize_max_ns)
+		out->resize_max_ns = dictionary->resize_max_ns;
+}
+
+
+/*-----------------------------
+
+ jaDictionaryGetStats()
+-----------------------------*/
+int jaDictionaryGetStats(struct jaDictionary* dictionary, struct jaDictionaryStats* out)
+{
+	size_t capacity = 0;
+
+	if (dictionary == NULL || out == NULL)
+		return 1;
+
+	memset(out, 0, sizeof(struct jaDictionaryStats));
+
+	if (dictionary->sharded != NULL)
+		ShardedStats(dictionary, out);
+	else
+	{
+		WriterLock(dictionary);
+		AddStats(dictionary, out);
+		WriterUnlock(dictionary);
+	}
+
+	capacity = out->buckets_no;
+
+	if ((dictionary->flags & JA_DICTIONARY_OPEN_ADDRESSING) == 0)
+		capacity *= BUCKET_DEPTH;
+
+	out->load = (capacity != 0) ? (unsigned)((out->items_no * 100) / capacity) : 0;
+	return 0;
+}
+
+
+/*-----------------------------
+
+ sDetach()
+-----------------------------*/
+static int sDetach(struct jaDictionaryItem* item)
+{
+	int ret = 1;
+
+	if (item->dictionary == NULL) // Another thread was first
+		return 1;
+
+	if (item->dictionary->flags & JA_DICTIONARY_OPEN_ADDRESSING)
+		ret = OpenAddressingDetach(item);
+	else
+		ret = LinearHashingDetach(item);
+
+	if (ret == 0)
+		item->dictionary = NULL;
+
+	return ret;
+}
+
+
+/*-----------------------------
+
+ sRemove()
+-----------------------------*/
+static int sRemove(struct jaDictionary* dictionary, struct jaDictionaryItem* item)
+{
+	if (sDetach(item) != 0)
+		return 1;
+
+	// Readers may be using it
+	if (dictionary->concurrent != NULL)
+		RetireItem(dictionary, item);
+	else
+	{
+		if (item->callback_delete != NULL)
+			item->callback_delete(item);
+
+		if ((dictionary->flags & JA_DICTIONARY_ARENA) == 0)
+			Deallocate(dictionary->allocator, item);
+	}
+
+	return 0;
+}
+
+
+/*-----------------------------
+
+ jaDictionaryRemoveN()
+-----------------------------*/
+int jaDictionaryRemoveN(struct jaDictionary* dictionary, const char* key, size_t key_size)
+{
+	struct jaDictionaryItem* item = NULL;
+	uint64_t hash = 0;
+	int ret = 1;
+
+	if (dictionary == NULL || key == NULL)
+		return 1;
+
+	hash = Hash(dictionary, key, key_size);
+
+	if (dictionary->sharded != NULL)
+		dictionary = ShardOf(dictionary, hash);
+
+	WriterLock(dictionary);
+
+	if ((item = sGet(dictionary, key, key_size, hash)) != NULL)
+		ret = sRemove(dictionary, item);
+
+	WriterUnlock(dictionary);
+	return ret;
+}
+
+
+/*-----------------------------
+
+ jaDictionaryRemove()
+-----------------------------*/
+inline void jaDictionaryRemove(struct jaDictionaryItem* item)
+{
+	struct jaDictionary* dictionary = NULL;
+
+	if (item != NULL && (dictionary = item->dictionary) != NULL)
+	{
+		WriterLock(dictionary);
+		sRemove(dictionary, item);
+		WriterUnlock(dictionary);
+	}
+}
+
+
+/*-----------------------------
+
+ jaDictionaryDetach()
+-----------------------------*/
+int jaDictionaryDetach(struct jaDictionaryItem* item)
+{
+	struct jaDictionary* dictionary = NULL;
+	int ret = 1;
+
+	if (item != NULL && (dictionary = item->dictionary) != NULL)
+	{
+		WriterLock(dictionary);
+
+		// Once readers finish the item is exclusively from the caller
+		if ((ret = sDetach(item)) == 0 && dictionary->concurrent != NULL)
+			Reclaim(dictionary);
+
+		WriterUnlock(dictionary);
+	}
+
+	return ret;
+}
+
+
+/*-----------------------------
+
+ jaDictionaryIterate()
+-----------------------------*/
+void jaDictionaryIterate(struct jaDictionary* dictionary, void (*callback)(struct jaDictionaryItem*, void*),
+                         void* extra_data)
+{
+	if (dictionary != NULL && callback != NULL)
+	{
+		WriterLock(dictionary);
+
+		if (dictionary->sharded != NULL)
+			ShardedIterate(dictionary, 1, callback, extra_data); // Locks each shard
+		else if (dictionary->flags & JA_DICTIONARY_OPEN_ADDRESSING)
+			OpenAddressingIterate(dictionary, callback, extra_data);
+		else
+			LinearHashingIterate(dictionary, callback, extra_data);
+
+		WriterUnlock(dictionary);
+	}
+}
+
+
+/*-----------------------------
+
+ jaDictionaryIterateParallel()
+-----------------------------*/
+void jaDictionaryIterateParallel(struct jaDictionary* dictionary, size_t workers_no,
+                                 void (*callback)(struct jaDictionaryItem*, void*), void* extra_data)
+{
+	// Without shards there is nothing to divide
+	if (dictionary != NULL && callback != NULL && dictionary->sharded != NULL)
+		ShardedIterate(dictionary, workers_no, callback, extra_data);
+	else
+		jaDictionaryIterate(dictionary, callback, extra_data);
+}
+
+
+/*-----------------------------
+
+ sStart()
+-----------------------------*/
+static void sStart(struct jaDictionaryState* state)
+{
+	struct jaDictionary* dictionary = state->start;
+	state->start = NULL;
+
+	state->dictionary = dictionary;
+	state->table = (dictionary->sharded != NULL) ? &dictionary->sharded->shard[0].dictionary : dictionary;
+	state->shard = 0;
+	state->index = 0;
+	state->depth = 0;
+	state->bucket = NULL;
+	state->slots = NULL;
+
+	state->buffered_no = 0;
+	state->buffered_cursor = 0;
+}
+
+
+/*-----------------------------
+
+ sFill()
+-----------------------------*/
+static size_t sFill(struct jaDictionaryState* state, struct jaDictionaryItem** items, size_t items_no)
+{
+	struct jaDictionary* dictionary = NULL;
+	size_t n = 0;
+
+	while (n < items_no && state->table != NULL)
+	{
+		if (state->table->flags & JA_DICTIONARY_OPEN_ADDRESSING)
+			n += OpenAddressingNext(state, items + n, items_no - n);
+		else
+			n += LinearHashingNext(state, items + n, items_no - n);
+
+		// Following shard
+		if (state->table == NULL && (dictionary = state->dictionary)->sharded != NULL &&
+		    state->shard + 1 < dictionary->sharded->shards_no)
+		{
+			state->shard += 1;
+			state->table = &dictionary->sharded->shard[state->shard].dictionary;
+			state->index = 0;
+			state->depth = 0;
+			state->bucket = NULL;
+			state->slots = NULL;
+		}
+	}
+
+	return n;
+}
+
+
+/*-----------------------------
+
+ jaDictionaryIterateBatch()
+-----------------------------*/
+size_t jaDictionaryIterateBatch(struct jaDictionaryState* state, struct jaDictionaryItem** items, size_t items_no)
+{
+	size_t n = 0;
+
+	if (state->start != NULL)
+		sStart(state);
+
+	// Items that IterateNext() left behind
+	for (; n < items_no && state->buffered_cursor < state->buffered_no; n++)
+		items[n] = state->buffer[state->buffered_cursor++];
+
+	n += sFill(state, items + n, items_no - n);
+
+	state->actual = (n != 0) ? items[n - 1] : NULL;
+	return n;
+}
+
+
+/*-----------------------------
+
+ jaDictionaryIterateNext()
+-----------------------------*/
+struct jaDictionaryItem* jaDictionaryIterateNext(struct jaDictionaryState* state)
+{
+	if (state->start != NULL)
+		sStart(state);
+
+	// Returning one item per call is way slower than taking a few at
+	// once, as less loads of them (of the user) overlap in the CPU
+	if (state->buffered_cursor == state->buffered_no)
+	{
+		state->buffered_no = sFill(state, state->buffer, JA_DICTIONARY_STATE_BUFFER);
+		state->buffered_cursor = 0;
+	}
+
+	if (state->buffered_cursor == state->buffered_no)
+		state->actual = NULL;
+	else
+		state->actual = state->buffer[state->buffered_cursor++];
+
+	return state->actual;
+}
@@ -0,0 +1,601 @@
+/*-----------------------------
+
+MIT License
+
+Copyright (c) 2019 Alexander Brandt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-------------------------------
+
+ [frozen.c]
+ - Alexander Brandt 2020
+
+ Minimal perfect hashing, by hash and displace. Keys are grouped
+ in buckets, and for the biggest ones first we look for a
+ displacement that puts all their keys in free slots.
+
+ http://cmph.sourceforge.net/papers/esa09.pdf
+ http://stevehanov.ca/blog/?id=119
+-----------------------------*/
+
+#include "private.h"
+
+
+#define MAGIC "jaFrozen"
+#define BYTE_ORDER_MARK 0x01020304
+
+#define SEEDS_MAX 16
+#define DISPLACEMENTS_MAX (1 << 20)
+#define DIRECT_SLOT 0x80000000 // Displacement that is directly a slot, for buckets of one key
+
+#define ITEMS_MAX 0x7FFFFFFF
+#define KEYS_SIZE_MAX 0xFFFFFFFF
+
+struct FrozenHeader
+{
+	char magic[8];
+	uint32_t byte_order; // Blobs aren't portable between endianness
+	uint32_t items_no;   // Also the number of buckets and slots
+	uint64_t seed;
+	uint64_t data_size;
+	uint64_t keys_size; // Packed, NULL terminated
+	uint64_t blob_size;
+};
+
+struct FrozenEntry
+{
+	uint64_t hash;
+	uint32_t key_offset;
+	uint32_t key_size;
+};
+
+struct jaFrozenDictionary
+{
+	uint8_t* owned_blob;                 // NULL if loaded from the user one
+	const struct jaAllocator* allocator; // That of the frozen dictionary
+
+	const struct FrozenHeader* header;
+	const uint32_t* displacement;
+	const struct FrozenEntry* entry;
+	const uint8_t* data;
+	const char* keys;
+
+	size_t data_stride;
+};
+
+struct Layout
+{
+	size_t displacement;
+	size_t entry;
+	size_t data;
+	size_t keys;
+	size_t blob_size;
+};
+
+struct Key
+{
+	uint64_t hash;
+	const struct jaDictionaryItem* item;
+};
+
+
+/*-----------------------------
+
+ sRange()
+-----------------------------*/
+static inline uint32_t sRange(uint32_t value, uint32_t n)
+{
+	// Like a modulo, without the division
+	return (uint32_t)(((uint64_t)value * n) >> 32);
+}
+
+
+/*-----------------------------
+
+ sSlot()
+-----------------------------*/
+static inline uint32_t sSlot(uint64_t hash, uint32_t displacement, uint32_t n)
+{
+	if (displacement & DIRECT_SLOT)
+		return displacement & ~(uint32_t)DIRECT_SLOT;
+
+	// Integer mix (splitmix64 finalizer), cheaper than hashing the key again
+	hash ^= (uint64_t)displacement * 0x9E3779B97F4A7C15;
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EB;
+	hash = hash ^ (hash >> 31);
+
+	return sRange((uint32_t)hash, n);
+}
+
+
+/*-----------------------------
+
+ sBucket()
+-----------------------------*/
+static inline uint32_t sBucket(uint64_t hash, uint32_t n)
+{
+	return sRange((uint32_t)(hash >> 32), n);
+}
+
+
+/*-----------------------------
+
+ sAlign8()
+-----------------------------*/
+static inline size_t sAlign8(size_t value)
+{
+	return (value + 7) & ~(size_t)7;
+}
+
+
+/*-----------------------------
+
+ sLayout()
+-----------------------------*/
+static void sLayout(size_t items_no, size_t data_stride, size_t keys_size, struct Layout* out)
+{
+	out->displacement = sizeof(struct FrozenHeader);
+	out->entry = sAlign8(out->displacement + sizeof(uint32_t) * items_no);
+	out->data = out->entry + sizeof(struct FrozenEntry) * items_no;
+	out->keys = out->data + data_stride * items_no;
+	out->blob_size = out->keys + keys_size;
+}
+
+
+/*-----------------------------
+
+ sCompareKeys()
+-----------------------------*/
+static int sCompareKeys(const void* a, const void* b)
+{
+	const struct Key* ka = a;
+	const struct Key* kb = b;
+
+	if (ka->hash != kb->hash)
+		return (ka->hash < kb->hash) ? -1 : 1;
+
+	// Same hash, same key, in a way that duplicates end together
+	if (ka->item->key_size != kb->item->key_size)
+		return (ka->item->key_size < kb->item->key_size) ? -1 : 1;
+
+	return memcmp(ka->item->key, kb->item->key, ka->item->key_size);
+}
+
+
+/*-----------------------------
+
+ sHashKeys()
+-----------------------------*/
+static int sHashKeys(struct Key* keys, size_t* keys_no, uint64_t seed)
+{
+	size_t unique_no = 0;
+
+	for (size_t i = 0; i < *keys_no; i++)
+		keys[i].hash = WyHash(keys[i].item->key, keys[i].item->key_size, seed);
+
+	qsort(keys, *keys_no, sizeof(struct Key), sCompareKeys);
+
+	for (size_t i = 0; i < *keys_no; i++)
+	{
+		if (unique_no != 0 && keys[unique_no - 1].hash == keys[i].hash)
+		{
+			// Duplicated keys are dropped, as Get() only returns one of them.
+			// But no displacement can separate different keys with same hash
+			if (sCompareKeys(&keys[unique_no - 1], &keys[i]) == 0)
+				continue;
+
+			return 1;
+		}
+
+		keys[unique_no++] = keys[i];
+	}
+
+	*keys_no = unique_no;
+	return 0;
+}
+
+
+/*-----------------------------
+
+ sDisplace()
+-----------------------------*/
+static int sDisplace(const struct jaAllocator* allocator, const struct Key* keys, uint32_t n, uint32_t* displacement,
+                     uint32_t* slot_key)
+{
+	uint32_t* bucket_start = NULL; // Keys are sorted by hash, not by bucket
+	uint32_t* bucket_key = NULL;
+	uint32_t* order = NULL;
+	uint32_t* slot = NULL;
+	uint32_t* count = NULL;
+	uint32_t max_size = 0;
+	uint32_t free_slot = 0;
+	int ret = 1;
+
+	if (n == 0)
+		return 0;
+
+	bucket_start = AllocateZero(allocator, sizeof(uint32_t) * ((size_t)n + 1));
+	bucket_key = Allocate(allocator, sizeof(uint32_t) * n);
+	order = Allocate(allocator, sizeof(uint32_t) * n);
+
+	if (bucket_start == NULL || bucket_key == NULL || order == NULL)
+		goto return_failure;
+
+	// Group keys by bucket (counting sort)
+	for (uint32_t i = 0; i < n; i++)
+		bucket_start[sBucket(keys[i].hash, n) + 1] += 1;
+
+	for (uint32_t b = 0; b < n; b++)
+	{
+		if (bucket_start[b + 1] > max_size)
+			max_size = bucket_start[b + 1];
+
+		bucket_start[b + 1] += bucket_start[b];
+	}
+
+	if ((count = Allocate(allocator, sizeof(uint32_t) * ((size_t)max_size + 2))) == NULL ||
+	    (slot = Allocate(allocator, sizeof(uint32_t) * max_size)) == NULL)
+		goto return_failure;
+
+	for (uint32_t i = 0; i < n; i++) // Starts used as cursors...
+		bucket_key[bucket_start[sBucket(keys[i].hash, n)]++] = i;
+
+	for (uint32_t b = n; b > 0; b--) // ...so now they are ends
+		bucket_start[b] = bucket_start[b - 1];
+
+	bucket_start[0] = 0;
+
+	// Biggest buckets first (counting sort again)
+	memset(count, 0, sizeof(uint32_t) * ((size_t)max_size + 2));
+
+	for (uint32_t b = 0; b < n; b++)
+		count[max_size - (bucket_start[b + 1] - bucket_start[b]) + 1] += 1;
+
+	for (uint32_t s = 0; s <= max_size; s++)
+		count[s + 1] += count[s];
+
+	for (uint32_t b = 0; b < n; b++)
+		order[count[max_size - (bucket_start[b + 1] - bucket_start[b])]++] = b;
+
+	// Displace
+	for (uint32_t i = 0; i < n; i++)
+		slot_key[i] = UINT32_MAX;
+
+	for (uint32_t o = 0; o < n; o++)
+	{
+		uint32_t b = order[o];
+		uint32_t size = bucket_start[b + 1] - bucket_start[b];
+		uint32_t d = 0;
+
+		if (size == 0)
+		{
+			displacement[b] = 0;
+			continue;
+		}
+
+		if (size == 1)
+		{
+			// There are as many slots as keys, one is free for sure
+			while (slot_key[free_slot] != UINT32_MAX)
+				free_slot++;
+
+			displacement[b] = DIRECT_SLOT | free_slot;
+			slot_key[free_slot] = bucket_key[bucket_start[b]];
+			continue;
+		}
+
+		for (d = 0; d < DISPLACEMENTS_MAX; d++)
+		{
+			uint32_t k = 0;
+
+			for (; k < size; k++)
+			{
+				slot[k] = sSlot(keys[bucket_key[bucket_start[b] + k]].hash, d, n);
+
+				if (slot_key[slot[k]] != UINT32_MAX)
+					break;
+
+				slot_key[slot[k]] = bucket_key[bucket_start[b] + k]; // Provisionally
+			}
+
+			if (k == size)
+				break;
+
+			while (k-- != 0) // Undo
+				slot_key[slot[k]] = UINT32_MAX;
+		}
+
+		if (d == DISPLACEMENTS_MAX)
+			goto return_failure;
+
+		displacement[b] = d;
+	}
+
+	ret = 0;
+
+return_failure:
+	Deallocate(allocator, bucket_start);
+	Deallocate(allocator, bucket_key);
+	Deallocate(allocator, order);
+	Deallocate(allocator, count);
+	Deallocate(allocator, slot);
+	return ret;
+}
+
+
+/*-----------------------------
+
+ sSetPointers()
+-----------------------------*/
+static void sSetPointers(struct jaFrozenDictionary* frozen, const uint8_t* blob)
+{
+	const struct FrozenHeader* header = (const struct FrozenHeader*)blob;
+	struct Layout layout;
+
+	frozen->data_stride = sAlign8((size_t)header->data_size);
+	sLayout(header->items_no, frozen->data_stride, (size_t)header->keys_size, &layout);
+
+	frozen->header = header;
+	frozen->displacement = (const uint32_t*)(blob + layout.displacement);
+	frozen->entry = (const struct FrozenEntry*)(blob + layout.entry);
+	frozen->data = blob + layout.data;
+	frozen->keys = (const char*)(blob + layout.keys);
+}
+
+
+/*-----------------------------
+
+ sBuild()
+-----------------------------*/
+static struct jaFrozenDictionary* sBuild(const struct jaAllocator* allocator, const struct Key* keys, uint32_t n,
+                                         uint64_t seed, const uint32_t* displacement, const uint32_t* slot_key,
+                                         size_t data_size)
+{
+	struct jaFrozenDictionary* frozen = NULL;
+	struct FrozenHeader* header = NULL;
+	struct FrozenEntry* entry = NULL;
+	struct Layout layout;
+	size_t keys_size = 0;
+	size_t offset = 0;
+
+	for (uint32_t i = 0; i < n; i++)
+		keys_size += keys[i].item->key_size + 1;
+
+	if (keys_size > KEYS_SIZE_MAX || (frozen = AllocateZero(allocator, sizeof(struct jaFrozenDictionary))) == NULL)
+		return NULL;
+
+	sLayout(n, sAlign8(data_size), keys_size, &layout);
+	frozen->allocator = allocator;
+
+	if ((frozen->owned_blob = AllocateZero(allocator, layout.blob_size)) == NULL)
+	{
+		Deallocate(allocator, frozen);
+		return NULL;
+	}
+
+	header = (struct FrozenHeader*)frozen->owned_blob;
+	memcpy(header->magic, MAGIC, sizeof(header->magic));
+	header->byte_order = BYTE_ORDER_MARK;
+	header->items_no = n;
+	header->seed = seed;
+	header->data_size = data_size;
+	header->keys_size = keys_size;
+	header->blob_size = layout.blob_size;
+
+	sSetPointers(frozen, frozen->owned_blob);
+	memcpy((uint32_t*)frozen->displacement, displacement, sizeof(uint32_t) * n);
+
+	// Entries, data and keys in slot order, the same that a lookup follows
+	for (uint32_t s = 0; s < n; s++)
+	{
+		const struct jaDictionaryItem* item = keys[slot_key[s]].item;
+
+		entry = (struct FrozenEntry*)&frozen->entry[s];
+		entry->hash = keys[slot_key[s]].hash;
+		entry->key_offset = (uint32_t)offset;
+		entry->key_size = (uint32_t)item->key_size;
+
+		memcpy((char*)frozen->keys + offset, item->key, item->key_size + 1);
+		offset += item->key_size + 1;
+
+		if (data_size != 0 && item->data != NULL)
+			memcpy((uint8_t*)frozen->data + frozen->data_stride * s, item->data, data_size);
+	}
+
+	return frozen;
+}
+
+
+/*-----------------------------
+
+ jaDictionaryFreeze()
+-----------------------------*/
+struct jaFrozenDictionary* jaDictionaryFreeze(struct jaDictionary* dictionary, size_t data_size)
+{
+	struct jaFrozenDictionary* frozen = NULL;
+	struct jaDictionaryItem* batch[64];
+	struct jaDictionaryState state = {0};
+	struct Key* keys = NULL;
+	size_t allocated_no = 0;
+	size_t keys_no = 0;
+	size_t n = 0;
+
+	uint32_t* displacement = NULL;
+	uint32_t* slot_key = NULL;
+
+	if (dictionary == NULL)
+		return NULL;
+
+	// Collect items
+	state.start = dictionary;
+	while ((n = jaDictionaryIterateBatch(&state, batch, 64)) != 0)
+		keys_no += n;
+
+	if (keys_no > ITEMS_MAX || (keys = Allocate(dictionary->allocator, sizeof(struct Key) * (keys_no + 1))) == NULL)
+		return NULL;
+
+	// Not a snapshot, items added meanwhile by other threads may be
+	// in or out, yet never more than what we allocated
+	allocated_no = keys_no;
+	keys_no = 0;
+	state.start = dictionary;
+
+	while (keys_no < allocated_no && (n = jaDictionaryIterateBatch(&state, batch, 64)) != 0)
+	{
+		for (size_t i = 0; i < n && keys_no < allocated_no; i++)
+			keys[keys_no++].item = batch[i];
+	}
+
+	displacement = Allocate(dictionary->allocator, sizeof(uint32_t) * (keys_no + 1));
+	slot_key = Allocate(dictionary->allocator, sizeof(uint32_t) * (keys_no + 1));
+
+	// Some seeds may give different keys with the same hash, or
+	// a bucket that no displacement manages to fit
+	for (uint64_t s = 0; s < SEEDS_MAX && displacement != NULL && slot_key != NULL; s++)
+	{
+		uint64_t seed = WyHash((const char*)&s, sizeof(uint64_t), 0);
+		size_t unique_no = keys_no;
+
+		if (sHashKeys(keys, &unique_no, seed) != 0)
+			continue;
+
+		if (sDisplace(dictionary->allocator, keys, (uint32_t)unique_no, displacement, slot_key) != 0)
+			continue;
+
+		frozen = sBuild(dictionary->allocator, keys, (uint32_t)unique_no, seed, displacement, slot_key, data_size);
+		break;
+	}
+
+	Deallocate(dictionary->allocator, keys);
+	Deallocate(dictionary->allocator, displacement);
+	Deallocate(dictionary->allocator, slot_key);
+	return frozen;
+}
+
+
+/*-----------------------------
+
+ jaFrozenDictionaryLoad()
+-----------------------------*/
+struct jaFrozenDictionary* jaFrozenDictionaryLoad(const void* blob, size_t size)
+{
+	const struct FrozenHeader* header = blob;
+	struct jaFrozenDictionary* frozen = NULL;
+	struct Layout layout;
+
+	if (blob == NULL || size < sizeof(struct FrozenHeader) || ((uintptr_t)blob & 7) != 0)
+		return NULL;
+
+	if (memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0 || header->byte_order != BYTE_ORDER_MARK ||
+	    header->items_no > ITEMS_MAX || header->keys_size > KEYS_SIZE_MAX || header->data_size > SIZE_MAX / 2)
+		return NULL;
+
+	// Only the layout is checked, contents are trusted (yet
+	// lookups never access outside the blob)
+	sLayout(header->items_no, sAlign8((size_t)header->data_size), (size_t)header->keys_size, &layout);
+
+	if (header->blob_size != layout.blob_size || layout.blob_size > size)
+		return NULL;
+
+	if ((frozen = AllocateZero(NULL, sizeof(struct jaFrozenDictionary))) == NULL)
+		return NULL;
+
+	sSetPointers(frozen, blob);
+	return frozen;
+}
+
+
+/*-----------------------------
+
+ jaFrozenDictionaryDelete()
+-----------------------------*/
+void jaFrozenDictionaryDelete(struct jaFrozenDictionary* frozen)
+{
+	if (frozen != NULL)
+	{
+		Deallocate(frozen->allocator, frozen->owned_blob);
+		Deallocate(frozen->allocator, frozen);
+	}
+}
+
+
+/*-----------------------------
+
+ jaFrozenDictionaryGet()
+-----------------------------*/
+inline const void* jaFrozenDictionaryGet(const struct jaFrozenDictionary* frozen, const char* key)
+{
+	if (key == NULL)
+		return NULL;
+
+	return jaFrozenDictionaryGetN(frozen, key, strlen(key));
+}
+
+
+/*-----------------------------
+
+ jaFrozenDictionaryGetN()
+-----------------------------*/
+const void* jaFrozenDictionaryGetN(const struct jaFrozenDictionary* frozen, const char* key, size_t key_size)
+{
+	const struct FrozenEntry* entry = NULL;
+	uint32_t n = 0;
+	uint32_t slot = 0;
+	uint64_t hash = 0;
+
+	if (frozen == NULL || key == NULL || (n = frozen->header->items_no) == 0)
+		return NULL;
+
+	// One hash, one probe, one comparison
+	hash = WyHash(key, key_size, frozen->header->seed);
+	slot = sSlot(hash, frozen->displacement[sBucket(hash, n)], n);
+
+	if (slot >= n)
+		return NULL;
+
+	entry = &frozen->entry[slot];
+
+	if (entry->hash != hash || entry->key_size != key_size ||
+	    (uint64_t)entry->key_offset + key_size >= frozen->header->keys_size ||
+	    memcmp(frozen->keys + entry->key_offset, key, key_size) != 0)
+		return NULL;
+
+	if (frozen->header->data_size == 0)
+		return frozen->keys + entry->key_offset;
+
+	return frozen->data + frozen->data_stride * slot;
+}
+
+
+/*-----------------------------
+
+ jaFrozenDictionaryBlob()
+-----------------------------*/
+const void* jaFrozenDictionaryBlob(const struct jaFrozenDictionary* frozen, size_t* size)
+{
+	if (frozen == NULL)
+		return NULL;
+
+	if (size != NULL)
+		*size = (size_t)frozen->header->blob_size;
+
+	return frozen->header;
+}
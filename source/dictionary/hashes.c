@@ -0,0 +1,327 @@
+/*-----------------------------
+
+MIT License
+
+Copyright (c) 2019 Alexander Brandt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-------------------------------
+
+ [hashes.c]
+ - Alexander Brandt 2019-2020
+
+ https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+ https://github.com/wangyi-fudan/wyhash
+ https://www.aumasson.jp/siphash/siphash.pdf
+-----------------------------*/
+
+#include "private.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/random.h>
+#elif defined(_WIN32)
+#include <bcrypt.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#define HAS_ARC4RANDOM
+#endif
+
+
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325
+#define FNV_PRIME 0x100000001B3
+
+#define WY_P0 0xA0761D6478BD642F
+#define WY_P1 0xE7037ED1A0B428DB
+#define WY_P2 0x8EBC6AF09C88C6E3
+#define WY_P3 0x589965CC75374CC3
+
+#define SIP_C_ROUNDS 1
+#define SIP_D_ROUNDS 3
+
+
+/*-----------------------------
+
+ jaFNV1Hash()
+-----------------------------*/
+uint64_t jaFNV1Hash(const char* key, size_t size)
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash = hash ^ (uint64_t)key[i];
+		hash = hash * FNV_PRIME;
+	}
+
+	return hash;
+}
+
+
+/*-----------------------------
+
+ sMum()
+-----------------------------*/
+static inline void sMum(uint64_t* a, uint64_t* b)
+{
+	// 64x64 bits multiplication, the 128 bits result
+	// splitted as low half in 'a', and high in 'b'
+#if defined(__SIZEOF_INT128__)
+	__uint128_t r = (__uint128_t)(*a) * (*b);
+	*a = (uint64_t)r;
+	*b = (uint64_t)(r >> 64);
+
+#elif defined(_MSC_VER) && defined(_M_X64)
+	*a = _umul128(*a, *b, b);
+
+#else
+	uint64_t ha = *a >> 32, la = (uint32_t)*a;
+	uint64_t hb = *b >> 32, lb = (uint32_t)*b;
+
+	uint64_t hh = ha * hb, hl = ha * lb;
+	uint64_t lh = la * hb, ll = la * lb;
+
+	uint64_t t = ll + (hl << 32);
+	uint64_t carry = (t < ll) ? 1 : 0;
+	uint64_t low = t + (lh << 32);
+
+	carry += (low < t) ? 1 : 0;
+
+	*a = low;
+	*b = hh + (hl >> 32) + (lh >> 32) + carry;
+#endif
+}
+
+
+static inline uint64_t sMix(uint64_t a, uint64_t b)
+{
+	sMum(&a, &b);
+	return a ^ b;
+}
+
+
+static inline uint64_t sRead8(const uint8_t* p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(uint64_t));
+	return v;
+}
+
+
+static inline uint64_t sRead4(const uint8_t* p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(uint32_t));
+	return v;
+}
+
+
+static inline uint64_t sRead3(const uint8_t* p, size_t size)
+{
+	return ((uint64_t)p[0] << 16) | ((uint64_t)p[size >> 1] << 8) | (uint64_t)p[size - 1];
+}
+
+
+/*-----------------------------
+
+ WyHash()
+-----------------------------*/
+uint64_t WyHash(const char* key, size_t size, uint64_t seed)
+{
+	// Based on wyhash (public domain), it consumes 16 bytes per step
+	// with a multiplication each, three independent lanes for long keys
+	const uint8_t* p = (const uint8_t*)key;
+	uint64_t a = 0;
+	uint64_t b = 0;
+
+	seed ^= sMix(seed ^ WY_P0, WY_P1);
+
+	if (size <= 16)
+	{
+		if (size >= 4)
+		{
+			a = (sRead4(p) << 32) | sRead4(p + ((size >> 3) << 2));
+			b = (sRead4(p + size - 4) << 32) | sRead4(p + size - 4 - ((size >> 3) << 2));
+		}
+		else if (size > 0)
+			a = sRead3(p, size);
+	}
+	else
+	{
+		size_t i = size;
+
+		if (i > 48)
+		{
+			uint64_t seed1 = seed;
+			uint64_t seed2 = seed;
+
+			do
+			{
+				seed = sMix(sRead8(p) ^ WY_P1, sRead8(p + 8) ^ seed);
+				seed1 = sMix(sRead8(p + 16) ^ WY_P2, sRead8(p + 24) ^ seed1);
+				seed2 = sMix(sRead8(p + 32) ^ WY_P3, sRead8(p + 40) ^ seed2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+
+			seed ^= seed1 ^ seed2;
+		}
+
+		while (i > 16)
+		{
+			seed = sMix(sRead8(p) ^ WY_P1, sRead8(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+
+		// Last 16 bytes, overlapping already consumed ones
+		a = sRead8(p + i - 16);
+		b = sRead8(p + i - 8);
+	}
+
+	a ^= WY_P1;
+	b ^= seed;
+	sMum(&a, &b);
+
+	return sMix(a ^ WY_P0 ^ (uint64_t)size, b ^ WY_P1);
+}
+
+
+/*-----------------------------
+
+ jaWyHash()
+-----------------------------*/
+inline uint64_t jaWyHash(const char* key, size_t size)
+{
+	return WyHash(key, size, 0);
+}
+
+
+/*-----------------------------
+
+ sSipRound()
+-----------------------------*/
+static inline uint64_t sRotate(uint64_t x, int bits)
+{
+	return (x << bits) | (x >> (64 - bits));
+}
+
+
+static inline void sSipRound(uint64_t* v)
+{
+	v[0] += v[1];
+	v[1] = sRotate(v[1], 13) ^ v[0];
+	v[0] = sRotate(v[0], 32);
+	v[2] += v[3];
+	v[3] = sRotate(v[3], 16) ^ v[2];
+	v[0] += v[3];
+	v[3] = sRotate(v[3], 21) ^ v[0];
+	v[2] += v[1];
+	v[1] = sRotate(v[1], 17) ^ v[2];
+	v[2] = sRotate(v[2], 32);
+}
+
+
+/*-----------------------------
+
+ SipHash()
+-----------------------------*/
+uint64_t SipHash(const char* key, size_t size, const uint64_t* seed)
+{
+	// SipHash-1-3, an attacker that doesn't know 'seed' can't
+	// predict which keys collide (words read in native order)
+	const uint8_t* p = (const uint8_t*)key;
+	uint64_t v[4];
+	uint64_t m = 0;
+	size_t i = 0;
+
+	v[0] = seed[0] ^ 0x736F6D6570736575;
+	v[1] = seed[1] ^ 0x646F72616E646F6D;
+	v[2] = seed[0] ^ 0x6C7967656E657261;
+	v[3] = seed[1] ^ 0x7465646279746573;
+
+	for (; i + 8 <= size; i += 8)
+	{
+		m = sRead8(p + i);
+		v[3] ^= m;
+
+		for (int r = 0; r < SIP_C_ROUNDS; r++)
+			sSipRound(v);
+
+		v[0] ^= m;
+	}
+
+	// Last 0-7 bytes, with the size in the highest one
+	m = (uint64_t)size << 56;
+
+	for (int shift = 0; i < size; i++, shift += 8)
+		m |= (uint64_t)p[i] << shift;
+
+	v[3] ^= m;
+
+	for (int r = 0; r < SIP_C_ROUNDS; r++)
+		sSipRound(v);
+
+	v[0] ^= m;
+	v[2] ^= 0xFF;
+
+	for (int r = 0; r < SIP_D_ROUNDS; r++)
+		sSipRound(v);
+
+	return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
+
+/*-----------------------------
+
+ RandomSeed()
+-----------------------------*/
+void RandomSeed(uint64_t* seed)
+{
+	static size_t calls_no = 0;
+	struct timespec t;
+	int done = 0;
+
+#if defined(__linux__)
+	ssize_t r = 0;
+
+	do // Never blocks, if early at boot the mix below is all we have
+		r = getrandom(seed, sizeof(uint64_t) * 2, GRND_NONBLOCK);
+	while (r < 0 && errno == EINTR);
+
+	done = (r == (ssize_t)(sizeof(uint64_t) * 2));
+#elif defined(_WIN32)
+	done = BCRYPT_SUCCESS(BCryptGenRandom(NULL, (PUCHAR)seed, sizeof(uint64_t) * 2, BCRYPT_USE_SYSTEM_PREFERRED_RNG));
+#elif defined(HAS_ARC4RANDOM)
+	arc4random_buf(seed, sizeof(uint64_t) * 2);
+	done = 1;
+#endif
+
+	if (done == 0)
+		seed[0] = seed[1] = 0;
+
+	// Whatever the system gave (or not), different across calls and processes
+	timespec_get(&t, TIME_UTC);
+	seed[0] ^= WyHash((const char*)&t, sizeof(struct timespec), (uint64_t)(uintptr_t)&t);
+	seed[1] ^= WyHash((const char*)seed, sizeof(uint64_t), (uint64_t)AtomicAddSize(&calls_no, 1));
+}
@@ -0,0 +1,629 @@
+/*-----------------------------
+
+MIT License
+
+Copyright (c) 2019 Alexander Brandt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-------------------------------
+
+ [linear-hashing.c]
+ - Alexander Brandt 2019-2020
+
+ https://stackoverflow.com/a/30874878
+ https://stackoverflow.com/a/29787467
+-----------------------------*/
+
+#include "private.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+
+#define INITIAL_BUCKETS 8 // Also the size of the first two segments
+#define GROWN_THRESHOLD 75
+#define SHRINK_THRESHOLD 40
+
+
+enum ResizeDirection
+{
+	RESIZE_GROWN,
+	RESIZE_SHRINK
+};
+
+struct CycleBucketState
+{
+	struct Bucket* bucket;
+	size_t depth;
+
+	struct Bucket* previous_bucket;
+};
+
+
+/*-----------------------------
+
+ sGetAddress()
+-----------------------------*/
+static inline size_t sGetAddress(const struct jaDictionary* dictionary, uint64_t hash)
+{
+	// Linear-hashing address, buckets before the pointer
+	// were already split and use one bit more
+	size_t address = (size_t)hash & dictionary->mask;
+
+	if (address < dictionary->pointer)
+		address = (size_t)hash & ((dictionary->mask << 1) | 1);
+
+	return address;
+}
+
+
+/*-----------------------------
+
+ sBitWidth()
+-----------------------------*/
+static inline size_t sBitWidth(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (value == 0) ? 0 : (size_t)(64 - __builtin_clzll(value));
+
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index = 0;
+	return (_BitScanReverse64(&index, value) == 0) ? 0 : (size_t)index + 1;
+
+#else
+	size_t width = 0;
+
+	for (; value != 0; value >>= 1)
+		width += 1;
+
+	return width;
+#endif
+}
+
+
+/*-----------------------------
+
+ sSegmentStart()
+-----------------------------*/
+static inline size_t sSegmentStart(size_t segment)
+{
+	// Segments double the previous size, to contain a level each
+	return (segment == 0) ? 0 : ((size_t)INITIAL_BUCKETS << (segment - 1));
+}
+
+
+/*-----------------------------
+
+ sBucket()
+-----------------------------*/
+static inline struct Bucket* sBucket(const struct jaDictionary* dictionary, size_t address)
+{
+	size_t segment = sBitWidth((uint64_t)(address / INITIAL_BUCKETS));
+	return &dictionary->segment[segment][address - sSegmentStart(segment)];
+}
+
+
+/*-----------------------------
+
+ sCycleBucket()
+-----------------------------*/
+static inline int sCycleBucket(struct CycleBucketState* state, struct jaDictionaryItem*** out)
+{
+	if (state->bucket != NULL)
+	{
+		*out = &state->bucket->item[state->depth];
+		state->depth += 1;
+
+		if (state->depth == BUCKET_DEPTH)
+		{
+			state->depth = 0;
+			state->previous_bucket = state->bucket;
+			state->bucket = state->bucket->overflow_next;
+		}
+
+		return 0;
+	}
+
+	return 1;
+}
+
+
+/*-----------------------------
+
+ sNewOverflowBucket()
+-----------------------------*/
+static struct Bucket* sNewOverflowBucket(struct jaDictionary* dictionary)
+{
+	struct Bucket* bucket = NULL;
+
+	if (dictionary->spare_buckets != NULL)
+	{
+		bucket = dictionary->spare_buckets;
+		dictionary->spare_buckets = bucket->overflow_next;
+	}
+	else if ((dictionary->flags & JA_DICTIONARY_ARENA) == 0)
+		bucket = Allocate(dictionary->allocator, sizeof(struct Bucket));
+	else
+		bucket = ArenaAlloc(&dictionary->arena, sizeof(struct Bucket));
+
+	if (bucket != NULL)
+		memset(bucket, 0, sizeof(struct Bucket));
+
+	return bucket;
+}
+
+
+/*-----------------------------
+
+ sDeleteOverflowBucket()
+-----------------------------*/
+static void sDeleteOverflowBucket(struct jaDictionary* dictionary, struct Bucket* bucket)
+{
+	// Kept for following additions, freed by LinearHashingDelete()
+	bucket->overflow_next = dictionary->spare_buckets;
+	dictionary->spare_buckets = bucket;
+}
+
+
+/*-----------------------------
+
+ sLocateInBucket()
+-----------------------------*/
+static int sLocateInBucket(struct jaDictionary* dictionary, struct jaDictionaryItem* item, size_t address)
+{
+	struct CycleBucketState state = {0};
+	struct jaDictionaryItem** item_slot = NULL;
+
+	// Add item into a bucket
+	state.bucket = sBucket(dictionary, address);
+
+	while (sCycleBucket(&state, &item_slot) != 1)
+	{
+		if (item_slot != NULL && *item_slot == NULL)
+		{
+			*item_slot = item;
+			break;
+		}
+	}
+
+	// ... Into an overflow bucket
+	if (item_slot == NULL || *item_slot != item)
+	{
+		struct Bucket* previous_bucket = state.previous_bucket;
+
+		if (previous_bucket == NULL)
+			previous_bucket = sBucket(dictionary, address);
+
+		if ((previous_bucket->overflow_next = sNewOverflowBucket(dictionary)) != NULL)
+			previous_bucket->overflow_next->item[0] = item;
+		else
+			return 1;
+	}
+
+	return 0;
+}
+
+
+/*-----------------------------
+
+ sNewSegment()
+-----------------------------*/
+static int sNewSegment(struct jaDictionary* dictionary)
+{
+	size_t segment = dictionary->segments_no;
+	size_t size = (segment == 0) ? INITIAL_BUCKETS : sSegmentStart(segment);
+
+	if (segment == LINEAR_HASHING_SEGMENTS)
+		return 1;
+
+	// Buckets are cleaned as they come into use
+	if ((dictionary->segment[segment] = Allocate(dictionary->allocator, size * sizeof(struct Bucket))) == NULL)
+		return 1;
+
+	dictionary->segments_no += 1;
+	return 0;
+}
+
+
+/*-----------------------------
+
+ sResize()
+-----------------------------*/
+static int sResize(struct jaDictionary* dictionary, enum ResizeDirection direction)
+{
+	struct jaDictionaryItem** item_slot = NULL;
+	struct CycleBucketState state = {0};
+
+	struct jaDictionaryItem* item = NULL;
+	size_t address = 0;
+
+	size_t to_rehash = dictionary->pointer;
+	struct Bucket* bucket = NULL;
+	uint64_t start = ResizeStart(dictionary);
+
+	// Update counters
+	if (direction == RESIZE_GROWN)
+	{
+		// Grown, a new segment once every level. As no bucket moves
+		// in memory, there is never a realloc of the whole table
+		if (dictionary->buckets_no == sSegmentStart(dictionary->segments_no) && sNewSegment(dictionary) != 0)
+			return 1;
+
+		// Always 'buckets_no == INITIAL_BUCKETS * 2^level + pointer'
+		dictionary->buckets_no += 1;
+		dictionary->pointer += 1;
+
+		if (dictionary->pointer == dictionary->mask + 1)
+		{
+			dictionary->pointer = 0;
+			dictionary->level += 1;
+			dictionary->mask = (dictionary->mask << 1) | 1;
+		}
+
+		memset(sBucket(dictionary, dictionary->buckets_no - 1), 0, sizeof(struct Bucket));
+	}
+	else
+	{
+		dictionary->buckets_no -= 1;
+		to_rehash = dictionary->buckets_no;
+
+		if (dictionary->pointer == 0)
+		{
+			dictionary->level -= 1;
+			dictionary->mask = dictionary->mask >> 1;
+			dictionary->pointer = dictionary->mask + 1;
+		}
+
+		dictionary->pointer -= 1;
+	}
+
+	// Rehash pointed bucket
+	bucket = sBucket(dictionary, to_rehash);
+	state.bucket = bucket;
+	state.depth = 0;
+
+	while (sCycleBucket(&state, &item_slot) != 1)
+	{
+		if (*item_slot != NULL)
+		{
+			item = *item_slot;
+			address = sGetAddress(dictionary, item->hash);
+
+			if (address == to_rehash) // New rehash produce the same address
+				continue;
+
+			// Relocate in a bucket
+			if (sLocateInBucket(dictionary, item, address) == 0)
+			{
+				*item_slot = NULL;
+				JA_DEBUG_PRINT(" - Rehashing '%s', address: %03zu -> %03zu\n", item->key, to_rehash, address);
+			}
+			else
+				return 1;
+		}
+	}
+
+	// Shrink
+	if (direction == RESIZE_SHRINK)
+	{
+		// Free overflow buckets (via a new iteration)
+		state.bucket = bucket;
+		state.depth = 0;
+
+		while (sCycleBucket(&state, &item_slot) != 1)
+		{
+			if (state.depth == 0 && state.previous_bucket != bucket)
+				sDeleteOverflowBucket(dictionary, state.previous_bucket);
+		}
+
+		// Free the last segment once a quarter of the previous one
+		// is also unused, to not allocate it back and forth
+		size_t last = dictionary->segments_no - 1;
+
+		if (last > 1 && dictionary->buckets_no <= sSegmentStart(last) - sSegmentStart(last) / 4)
+		{
+			Deallocate(dictionary->allocator, dictionary->segment[last]);
+			dictionary->segments_no -= 1;
+		}
+	}
+
+	JA_DEBUG_PRINT(" - Buckets: %zu (p: %zu)\n", dictionary->buckets_no, dictionary->pointer);
+	ResizeEnd(dictionary, start);
+	return 0;
+}
+
+
+/*-----------------------------
+
+ LinearHashingInit()
+-----------------------------*/
+int LinearHashingInit(struct jaDictionary* dictionary)
+{
+	dictionary->level = 0;
+	dictionary->mask = INITIAL_BUCKETS - 1;
+	dictionary->pointer = 0;
+	dictionary->buckets_no = INITIAL_BUCKETS;
+	dictionary->segments_no = 0;
+
+	dictionary->grow_threshold = GROWN_THRESHOLD;
+	dictionary->shrink_threshold = SHRINK_THRESHOLD;
+
+	if (sNewSegment(dictionary) != 0)
+		return 1;
+
+	memset(dictionary->segment[0], 0, INITIAL_BUCKETS * sizeof(struct Bucket));
+	return 0;
+}
+
+
+/*-----------------------------
+
+ LinearHashingDelete()
+-----------------------------*/
+void LinearHashingDelete(struct jaDictionary* dictionary)
+{
+	struct CycleBucketState state = {0};
+	struct jaDictionaryItem** item_slot = NULL;
+	struct Bucket* bucket = NULL;
+	struct Bucket* next = NULL;
+	bool arena = (dictionary->flags & JA_DICTIONARY_ARENA); // Frees everything at once, later
+
+	for (size_t i = 0; i < dictionary->buckets_no; i++)
+	{
+		bucket = sBucket(dictionary, i);
+		state.bucket = bucket;
+		state.previous_bucket = NULL;
+
+		while (sCycleBucket(&state, &item_slot) != 1)
+		{
+			if (*item_slot != NULL)
+			{
+				if ((*item_slot)->callback_delete != NULL)
+					(*item_slot)->callback_delete(*item_slot);
+
+				if (arena == false)
+					Deallocate(dictionary->allocator, *item_slot);
+			}
+
+			// Overflow buckets
+			if (arena == false && state.depth == 0 && state.previous_bucket != bucket)
+				Deallocate(dictionary->allocator, state.previous_bucket);
+		}
+	}
+
+	for (bucket = dictionary->spare_buckets; arena == false && bucket != NULL; bucket = next)
+	{
+		next = bucket->overflow_next;
+		Deallocate(dictionary->allocator, bucket);
+	}
+
+	for (size_t i = 0; i < dictionary->segments_no; i++)
+		Deallocate(dictionary->allocator, dictionary->segment[i]);
+}
+
+
+/*-----------------------------
+
+ LinearHashingAdd()
+-----------------------------*/
+int LinearHashingAdd(struct jaDictionary* dictionary, struct jaDictionaryItem* item)
+{
+	size_t address = sGetAddress(dictionary, item->hash);
+
+	if (sLocateInBucket(dictionary, item, address) != 0)
+		return 1;
+
+	JA_DEBUG_PRINT("(jaDictionaryAdd) key: '%s', address: %03zu, hash: 0x%016lX\n", item->key, address, item->hash);
+	dictionary->items_no++;
+
+	// Grown?, a failure here still leaves the item stored
+	if ((dictionary->items_no * 100) / (dictionary->buckets_no * BUCKET_DEPTH) > dictionary->grow_threshold)
+		sResize(dictionary, RESIZE_GROWN);
+
+	return 0;
+}
+
+
+/*-----------------------------
+
+ LinearHashingReserve()
+-----------------------------*/
+int LinearHashingReserve(struct jaDictionary* dictionary, size_t items_no)
+{
+	size_t buckets_no = (items_no * 100) / (dictionary->grow_threshold * BUCKET_DEPTH) + 1;
+
+	// Split buckets as many times as Add() would do, at once
+	while (dictionary->buckets_no < buckets_no)
+	{
+		if (sResize(dictionary, RESIZE_GROWN) != 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+
+/*-----------------------------
+
+ LinearHashingGet()
+-----------------------------*/
+struct jaDictionaryItem* LinearHashingGet(const struct jaDictionary* dictionary, const char* key, size_t size,
+                                          uint64_t hash)
+{
+	struct CycleBucketState state = {0};
+	struct jaDictionaryItem** item_slot = NULL;
+	size_t probes = 0;
+
+	state.bucket = sBucket(dictionary, sGetAddress(dictionary, hash));
+	while (sCycleBucket(&state, &item_slot) != 1)
+	{
+		probes += 1;
+
+		if (*item_slot != NULL && ItemMatch(*item_slot, key, size, hash) == true)
+		{
+			CountLookup(dictionary, probes);
+			return *item_slot;
+		}
+	}
+
+	CountLookup(dictionary, probes);
+	return NULL;
+}
+
+
+/*-----------------------------
+
+ LinearHashingDetach()
+-----------------------------*/
+int LinearHashingDetach(struct jaDictionaryItem* item)
+{
+	struct CycleBucketState state = {0};
+	struct jaDictionaryItem** item_slot = NULL;
+	struct jaDictionary* d = item->dictionary;
+	bool found = false;
+
+	size_t address = sGetAddress(d, item->hash);
+
+	JA_DEBUG_PRINT("(jaDictionaryDetach) key: '%s', address: %03zu, hash: 0x%016lX\n", item->key, address, item->hash);
+
+	state.bucket = sBucket(d, address);
+	while (sCycleBucket(&state, &item_slot) != 1)
+	{
+		if (*item_slot == item)
+		{
+			*item_slot = NULL;
+			found = true;
+			break;
+		}
+	}
+
+	if (found == false)
+		return 1;
+
+	d->items_no -= 1;
+
+	// Shrink?, as with grown a failure is harmless
+	if (d->buckets_no != INITIAL_BUCKETS &&
+	    (d->items_no * 100) / (d->buckets_no * BUCKET_DEPTH) < d->shrink_threshold)
+		sResize(d, RESIZE_SHRINK);
+
+	return 0;
+}
+
+
+/*-----------------------------
+
+ LinearHashingIterate()
+-----------------------------*/
+void LinearHashingIterate(struct jaDictionary* dictionary, void (*callback)(struct jaDictionaryItem*, void*),
+                          void* extra_data)
+{
+	struct CycleBucketState state = {0};
+	struct jaDictionaryItem** item_slot = NULL;
+
+	for (size_t i = 0; i < dictionary->buckets_no; i++)
+	{
+		state.bucket = sBucket(dictionary, i);
+		state.previous_bucket = NULL;
+
+		while (sCycleBucket(&state, &item_slot) != 1)
+		{
+			if (*item_slot != NULL)
+				callback(*item_slot, extra_data);
+		}
+	}
+}
+
+
+/*-----------------------------
+
+ LinearHashingNext()
+-----------------------------*/
+size_t LinearHashingNext(struct jaDictionaryState* state, struct jaDictionaryItem** items, size_t items_no)
+{
+	struct jaDictionary* dictionary = state->table;
+	struct Bucket* bucket = state->bucket;
+	size_t depth = state->depth;
+	size_t index = state->index;
+	size_t n = 0;
+
+	// Buckets in address order, each one followed by its overflow ones
+	while (n < items_no)
+	{
+		if (bucket == NULL)
+		{
+			if (index == dictionary->buckets_no)
+			{
+				state->table = NULL;
+				break;
+			}
+
+			bucket = sBucket(dictionary, index);
+			index += 1;
+		}
+
+		for (; depth < BUCKET_DEPTH && n < items_no; depth++)
+		{
+			if (bucket->item[depth] != NULL)
+				items[n++] = bucket->item[depth];
+		}
+
+		if (depth == BUCKET_DEPTH)
+		{
+			bucket = bucket->overflow_next;
+			depth = 0;
+		}
+	}
+
+	state->bucket = bucket;
+	state->depth = depth;
+	state->index = index;
+	return n;
+}
+
+
+/*-----------------------------
+
+ LinearHashingStats()
+-----------------------------*/
+void LinearHashingStats(struct jaDictionary* dictionary, struct jaDictionaryStats* out)
+{
+	struct Bucket* bucket = NULL;
+	size_t overflow_no = 0;
+
+	out->items_no += dictionary->items_no;
+	out->buckets_no += dictionary->buckets_no;
+	out->level = dictionary->level;
+	out->pointer = dictionary->pointer;
+
+	for (size_t i = 0; i < dictionary->buckets_no; i++)
+	{
+		overflow_no = 0;
+
+		for (bucket = sBucket(dictionary, i)->overflow_next; bucket != NULL; bucket = bucket->overflow_next)
+			overflow_no += 1;
+
+		if (overflow_no >= JA_DICTIONARY_HISTOGRAM_LEN)
+			overflow_no = JA_DICTIONARY_HISTOGRAM_LEN - 1;
+
+		out->histogram[overflow_no] += 1;
+	}
+}
@@ -0,0 +1,388 @@
+/*-----------------------------
+
+MIT License
+
+Copyright (c) 2019 Alexander Brandt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-------------------------------
+
+ [open-addressing.c]
+ - Alexander Brandt 2019-2020
+
+ https://abseil.io/about/design/swisstables
+ https://en.wikipedia.org/wiki/Open_addressing
+-----------------------------*/
+
+#include "private.h"
+
+
+#define INITIAL_SLOTS 16
+#define GROWN_THRESHOLD 80 // Counting tombstones, they also lengthen probes
+#define SHRINK_THRESHOLD 20
+
+#define CONTROL_EMPTY 0x80
+#define CONTROL_DELETED 0xFE
+
+
+/*-----------------------------
+
+ sFingerprint()
+-----------------------------*/
+static inline uint8_t sFingerprint(uint64_t hash)
+{
+	// Seven high bits, the slot index comes from the low ones. Being
+	// below 0x80, fingerprints never collide with the control values
+	return (uint8_t)(hash >> 57);
+}
+
+
+/*-----------------------------
+
+ sAllocSlots()
+-----------------------------*/
+static struct Slots* sAllocSlots(const struct jaAllocator* allocator, size_t slots_no)
+{
+	struct Slots* slots = NULL;
+
+	// Items pointers and control bytes share a single allocation
+	if ((slots = Allocate(allocator, sizeof(struct Slots) + slots_no * (sizeof(struct jaDictionaryItem*) + 1))) == NULL)
+		return NULL;
+
+	slots->slots_no = slots_no;
+	slots->retired_next = NULL;
+	slots->control = (uint8_t*)(slots->item + slots_no);
+
+	memset(slots->control, CONTROL_EMPTY, slots_no);
+	return slots;
+}
+
+
+/*-----------------------------
+
+ sLocateInSlot()
+-----------------------------*/
+static void sLocateInSlot(struct jaDictionary* dictionary, struct Slots* slots, struct jaDictionaryItem* item)
+{
+	size_t mask = slots->slots_no - 1;
+	size_t i = (size_t)(item->hash & mask);
+
+	// Callers ensure that at least one slot is free
+	while (slots->control[i] < CONTROL_EMPTY)
+		i = (i + 1) & mask;
+
+	if (slots->control[i] == CONTROL_DELETED)
+		dictionary->tombstones_no -= 1;
+
+	// Concurrent readers check the control byte first
+	AtomicStorePtr((void**)&slots->item[i], item);
+	AtomicStoreU8(&slots->control[i], sFingerprint(item->hash));
+}
+
+
+/*-----------------------------
+
+ sRehash()
+-----------------------------*/
+static int sRehash(struct jaDictionary* dictionary, size_t new_slots_no)
+{
+	struct Slots* old_slots = dictionary->slots;
+	struct Slots* new_slots = NULL;
+	uint64_t start = ResizeStart(dictionary);
+
+	if ((new_slots = sAllocSlots(dictionary->allocator, new_slots_no)) == NULL)
+		return 1;
+
+	dictionary->tombstones_no = 0;
+
+	for (size_t i = 0; i < old_slots->slots_no; i++)
+	{
+		if (old_slots->control[i] < CONTROL_EMPTY)
+			sLocateInSlot(dictionary, new_slots, old_slots->item[i]);
+	}
+
+	JA_DEBUG_PRINT(" - Slots: %zu -> %zu\n", old_slots->slots_no, new_slots_no);
+
+	// Readers may be still probing the old slots
+	AtomicStorePtr((void**)&dictionary->slots, new_slots);
+
+	if (dictionary->concurrent != NULL)
+		RetireSlots(dictionary, old_slots);
+	else
+		Deallocate(dictionary->allocator, old_slots);
+
+	ResizeEnd(dictionary, start);
+	return 0;
+}
+
+
+/*-----------------------------
+
+ OpenAddressingInit()
+-----------------------------*/
+int OpenAddressingInit(struct jaDictionary* dictionary)
+{
+	dictionary->tombstones_no = 0;
+	dictionary->grow_threshold = GROWN_THRESHOLD;
+	dictionary->shrink_threshold = SHRINK_THRESHOLD;
+
+	if ((dictionary->slots = sAllocSlots(dictionary->allocator, INITIAL_SLOTS)) == NULL)
+		return 1;
+
+	return 0;
+}
+
+
+/*-----------------------------
+
+ OpenAddressingDelete()
+-----------------------------*/
+void OpenAddressingDelete(struct jaDictionary* dictionary)
+{
+	struct Slots* slots = dictionary->slots;
+	bool arena = (dictionary->flags & JA_DICTIONARY_ARENA); // Frees all items at once, later
+
+	for (size_t i = 0; i < slots->slots_no; i++)
+	{
+		if (slots->control[i] < CONTROL_EMPTY)
+		{
+			if (slots->item[i]->callback_delete != NULL)
+				slots->item[i]->callback_delete(slots->item[i]);
+
+			if (arena == false)
+				Deallocate(dictionary->allocator, slots->item[i]);
+		}
+	}
+
+	Deallocate(dictionary->allocator, slots);
+}
+
+
+/*-----------------------------
+
+ OpenAddressingAdd()
+-----------------------------*/
+int OpenAddressingAdd(struct jaDictionary* dictionary, struct jaDictionaryItem* item)
+{
+	size_t slots_no = dictionary->slots->slots_no;
+
+	// Grown? (or just clean tombstones)
+	if ((dictionary->items_no + dictionary->tombstones_no + 1) * 100 > slots_no * dictionary->grow_threshold)
+	{
+		size_t new_slots_no = slots_no;
+
+		while ((dictionary->items_no + 1) * 100 > new_slots_no * (dictionary->grow_threshold / 2))
+			new_slots_no *= 2;
+
+		// On failure we can continue as long an empty slot remains
+		if (sRehash(dictionary, new_slots_no) != 0 &&
+		    dictionary->items_no + dictionary->tombstones_no + 1 >= slots_no)
+			return 1;
+	}
+
+	sLocateInSlot(dictionary, dictionary->slots, item);
+	dictionary->items_no++;
+
+	JA_DEBUG_PRINT("(jaDictionaryAdd) key: '%s', slot: %03zu, hash: 0x%016lX\n", item->key,
+	               (size_t)(item->hash & (dictionary->slots->slots_no - 1)), item->hash);
+	return 0;
+}
+
+
+/*-----------------------------
+
+ OpenAddressingReserve()
+-----------------------------*/
+int OpenAddressingReserve(struct jaDictionary* dictionary, size_t items_no)
+{
+	size_t new_slots_no = dictionary->slots->slots_no;
+
+	while (items_no * 100 > new_slots_no * dictionary->grow_threshold)
+		new_slots_no *= 2;
+
+	if (new_slots_no == dictionary->slots->slots_no)
+		return 0;
+
+	return sRehash(dictionary, new_slots_no);
+}
+
+
+/*-----------------------------
+
+ OpenAddressingGet()
+-----------------------------*/
+struct jaDictionaryItem* OpenAddressingGet(const struct jaDictionary* dictionary, const char* key, size_t size,
+                                           uint64_t hash)
+{
+	// Loaded once, concurrent writers may replace it
+	const struct Slots* slots = AtomicLoadPtr((void* const*)&dictionary->slots);
+	struct jaDictionaryItem* item = NULL;
+	uint8_t fingerprint = sFingerprint(hash);
+	uint8_t control = 0;
+
+	size_t mask = slots->slots_no - 1;
+	size_t i = (size_t)(hash & mask);
+
+	size_t probes = 0;
+
+	// Only matching fingerprints lead us to touch the item
+	for (; probes < slots->slots_no; probes++)
+	{
+		if ((control = AtomicLoadU8(&slots->control[i])) == CONTROL_EMPTY)
+			break;
+
+		if (control == fingerprint)
+		{
+			item = AtomicLoadPtr((void* const*)&slots->item[i]);
+
+			if (ItemMatch(item, key, size, hash) == true)
+			{
+				CountLookup(dictionary, probes + 1);
+				return item;
+			}
+		}
+
+		i = (i + 1) & mask;
+	}
+
+	CountLookup(dictionary, probes + 1);
+	return NULL;
+}
+
+
+/*-----------------------------
+
+ OpenAddressingDetach()
+-----------------------------*/
+int OpenAddressingDetach(struct jaDictionaryItem* item)
+{
+	struct jaDictionary* d = item->dictionary;
+	struct Slots* slots = d->slots;
+
+	size_t mask = slots->slots_no - 1;
+	size_t i = (size_t)(item->hash & mask);
+
+	for (size_t probes = 0; probes < slots->slots_no; probes++)
+	{
+		if (slots->control[i] == CONTROL_EMPTY)
+			break;
+
+		if (slots->control[i] < CONTROL_EMPTY && slots->item[i] == item)
+		{
+			// If the next slot is empty no probe sequence continues
+			// trough this one, so there is no need of a tombstone
+			if (slots->control[(i + 1) & mask] == CONTROL_EMPTY)
+				AtomicStoreU8(&slots->control[i], CONTROL_EMPTY);
+			else
+			{
+				AtomicStoreU8(&slots->control[i], CONTROL_DELETED);
+				d->tombstones_no += 1;
+			}
+
+			d->items_no -= 1;
+
+			// Shrink?, a failure here is harmless
+			if (slots->slots_no > INITIAL_SLOTS && d->items_no * 100 < slots->slots_no * d->shrink_threshold)
+				sRehash(d, slots->slots_no / 2);
+
+			return 0;
+		}
+
+		i = (i + 1) & mask;
+	}
+
+	return 1;
+}
+
+
+/*-----------------------------
+
+ OpenAddressingIterate()
+-----------------------------*/
+void OpenAddressingIterate(struct jaDictionary* dictionary, void (*callback)(struct jaDictionaryItem*, void*),
+                           void* extra_data)
+{
+	struct Slots* slots = dictionary->slots;
+
+	for (size_t i = 0; i < slots->slots_no; i++)
+	{
+		if (slots->control[i] < CONTROL_EMPTY)
+			callback(slots->item[i], extra_data);
+	}
+}
+
+
+/*-----------------------------
+
+ OpenAddressingNext()
+-----------------------------*/
+size_t OpenAddressingNext(struct jaDictionaryState* state, struct jaDictionaryItem** items, size_t items_no)
+{
+	const struct Slots* slots = state->slots;
+	size_t i = state->index;
+	size_t n = 0;
+
+	// Kept from the first call, concurrent readers hold it while in a read section
+	if (slots == NULL)
+		slots = AtomicLoadPtr((void* const*)&state->table->slots);
+
+	// Control bytes are contiguous, only used slots lead us to the items pointers
+	for (; i < slots->slots_no && n < items_no; i++)
+	{
+		if (AtomicLoadU8(&slots->control[i]) < CONTROL_EMPTY)
+			items[n++] = AtomicLoadPtr((void* const*)&slots->item[i]);
+	}
+
+	if (i == slots->slots_no)
+		state->table = NULL;
+
+	state->slots = slots;
+	state->index = i;
+	return n;
+}
+
+
+/*-----------------------------
+
+ OpenAddressingStats()
+-----------------------------*/
+void OpenAddressingStats(struct jaDictionary* dictionary, struct jaDictionaryStats* out)
+{
+	struct Slots* slots = dictionary->slots;
+	size_t mask = slots->slots_no - 1;
+	size_t distance = 0;
+
+	out->items_no += dictionary->items_no;
+	out->tombstones_no += dictionary->tombstones_no;
+	out->buckets_no += slots->slots_no;
+
+	for (size_t i = 0; i < slots->slots_no; i++)
+	{
+		if (slots->control[i] < CONTROL_EMPTY)
+		{
+			distance = (i - (size_t)(slots->item[i]->hash & mask)) & mask;
+
+			if (distance >= JA_DICTIONARY_HISTOGRAM_LEN)
+				distance = JA_DICTIONARY_HISTOGRAM_LEN - 1;
+
+			out->histogram[distance] += 1;
+		}
+	}
+}
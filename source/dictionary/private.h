@@ -0,0 +1,248 @@
+/*-----------------------------
+
+ [dictionary/private.h]
+ - Alexander Brandt 2019-2020
+-----------------------------*/
+
+#ifndef JA_DICTIONARY_PRIVATE_H
+#define JA_DICTIONARY_PRIVATE_H
+
+	#include <stdbool.h>
+	#include <stdint.h>
+	#include <stdlib.h>
+	#include <string.h>
+	#include <time.h>
+
+	#include "../common.h"
+	#include "../threads.h"
+	#include "japan-dictionary.h"
+
+	#define BUCKET_DEPTH 2
+	#define LINEAR_HASHING_SEGMENTS 64
+
+	#define CACHE_LINE_SIZE 64
+	#define READER_STRIPES 32 // Readers spread their counters, to not share cache lines
+	#define RETIRED_ITEMS_MAX 256
+
+	struct Bucket
+	{
+		struct jaDictionaryItem* item[BUCKET_DEPTH];
+		struct Bucket* overflow_next;
+	};
+
+	struct Slots
+	{
+		size_t slots_no; // Always a power of two
+		struct Slots* retired_next;
+
+		uint8_t* control; // One fingerprint per slot, after the items pointers
+		struct jaDictionaryItem* item[];
+	};
+
+	struct ReaderStripe
+	{
+		size_t counter[2]; // Readers in an even and odd epoch
+		uint8_t padding[CACHE_LINE_SIZE - sizeof(size_t) * 2];
+	};
+
+	struct Concurrent
+	{
+		Mutex writer;
+
+		size_t epoch;
+		struct ReaderStripe reader[READER_STRIPES];
+
+		struct Slots* retired_slots;
+		struct jaDictionaryItem* retired_item[RETIRED_ITEMS_MAX];
+		size_t retired_items_no;
+	};
+
+	struct Arena
+	{
+		struct ArenaChunk* last;
+		size_t chunk_size; // Of the next chunk
+
+		const struct jaAllocator* allocator; // That of the dictionary
+	};
+
+	struct jaDictionary
+	{
+		enum jaDictionaryFlags flags;
+		size_t items_no;
+
+		const struct jaAllocator* allocator; // NULL for malloc(), realloc() and free()
+
+		uint64_t (*hash_function)(const char*, size_t); // Never NULL, a default one is set at creation
+		uint64_t seed[2];                               // If JA_DICTIONARY_SEEDED, replaces the function
+
+		struct Arena arena; // Items and overflow buckets, if JA_DICTIONARY_ARENA
+
+		unsigned grow_threshold;   // Percentages of the load factor
+		unsigned shrink_threshold; // Zero to never shrink
+
+		// If JA_DICTIONARY_STATS, lookups counters are atomic
+		size_t lookups_no;
+		size_t probes_no;
+		size_t resizes_no;
+		uint64_t resizes_ns;
+		uint64_t resize_max_ns;
+
+		// Linear hashing
+		size_t level;
+		size_t mask; // 'INITIAL_BUCKETS * 2^level - 1'
+		size_t pointer;
+		size_t buckets_no;
+		size_t segments_no;
+
+		struct Bucket* segment[LINEAR_HASHING_SEGMENTS]; // Never moved, so never reallocated
+		struct Bucket* spare_buckets;                    // Overflow ones, recycled from shrinks
+
+		// Open addressing
+		size_t tombstones_no;
+		struct Slots* slots; // Replaced as a whole by rehashes
+
+		// If JA_DICTIONARY_CONCURRENT
+		struct Concurrent* concurrent;
+
+		// If JA_DICTIONARY_SHARDED, only in the dictionary that routes keys
+		struct Sharded* sharded;
+
+		Mutex* lock; // Taken by writers, the concurrent one or that of a shard
+	};
+
+	uint64_t WyHash(const char* key, size_t size, uint64_t seed);
+	uint64_t SipHash(const char* key, size_t size, const uint64_t* seed);
+	void RandomSeed(uint64_t* seed);
+
+	struct Shard
+	{
+		struct jaDictionary dictionary; // Items point here
+		Mutex lock;
+	};
+
+	struct Sharded
+	{
+		size_t shards_no; // Always a power of two
+		int hash_shift;   // Keys routed by the bits below the fingerprint
+		struct Shard shard[];
+	};
+
+	static inline uint64_t Hash(const struct jaDictionary* dictionary, const char* key, size_t size)
+	{
+		if (dictionary->flags & JA_DICTIONARY_SEEDED)
+			return SipHash(key, size, dictionary->seed);
+
+		return dictionary->hash_function(key, size);
+	}
+
+	static inline bool ItemMatch(const struct jaDictionaryItem* item, const char* key, size_t size, uint64_t hash)
+	{
+		// Stored hashes discard most candidates without touching their keys
+		return (item->hash == hash && item->key_size == size && memcmp(item->key, key, size) == 0);
+	}
+
+	static inline void WriterLock(struct jaDictionary* dictionary)
+	{
+		if (dictionary->lock != NULL)
+			MutexLock(dictionary->lock);
+	}
+
+	static inline void WriterUnlock(struct jaDictionary* dictionary)
+	{
+		if (dictionary->lock != NULL)
+			MutexUnlock(dictionary->lock);
+	}
+
+	static inline struct jaDictionary* ShardOf(const struct jaDictionary* dictionary, uint64_t hash)
+	{
+		// Linear hashing and open addressing use the low bits, the
+		// fingerprint of the latter the top seven (see sFingerprint())
+		struct Sharded* sharded = dictionary->sharded;
+		return &sharded->shard[(size_t)(hash >> sharded->hash_shift) & (sharded->shards_no - 1)].dictionary;
+	}
+
+	static inline void CountLookup(const struct jaDictionary* dictionary, size_t probes)
+	{
+		// Counters aren't part of the table, lookups remain 'const'
+		struct jaDictionary* d = (struct jaDictionary*)dictionary;
+
+		if (d->flags & JA_DICTIONARY_STATS)
+		{
+			AtomicAddSize(&d->lookups_no, 1);
+			AtomicAddSize(&d->probes_no, probes);
+		}
+	}
+
+	static inline uint64_t Nanoseconds()
+	{
+		struct timespec t;
+		timespec_get(&t, TIME_UTC);
+
+		return (uint64_t)t.tv_sec * 1000000000 + (uint64_t)t.tv_nsec;
+	}
+
+	static inline uint64_t ResizeStart(const struct jaDictionary* dictionary)
+	{
+		return (dictionary->flags & JA_DICTIONARY_STATS) ? Nanoseconds() : 0;
+	}
+
+	static inline void ResizeEnd(struct jaDictionary* dictionary, uint64_t start)
+	{
+		uint64_t pause = 0;
+
+		if (dictionary->flags & JA_DICTIONARY_STATS)
+		{
+			pause = Nanoseconds() - start;
+			dictionary->resizes_no += 1;
+			dictionary->resizes_ns += pause;
+
+			if (pause > dictionary->resize_max_ns)
+				dictionary->resize_max_ns = pause;
+		}
+	}
+
+	void AddStats(struct jaDictionary* dictionary, struct jaDictionaryStats* out);
+
+	int ConcurrentInit(struct jaDictionary* dictionary);
+	void ConcurrentDelete(struct jaDictionary* dictionary);
+	void RetireItem(struct jaDictionary* dictionary, struct jaDictionaryItem* item);
+	void RetireSlots(struct jaDictionary* dictionary, struct Slots* slots);
+	void Reclaim(struct jaDictionary* dictionary);
+
+	int ShardedInit(struct jaDictionary* dictionary, size_t shards_no);
+	void ShardedDelete(struct jaDictionary* dictionary);
+	int ShardedReserve(struct jaDictionary* dictionary, size_t items_no);
+	void ShardedStats(struct jaDictionary* dictionary, struct jaDictionaryStats* out);
+	size_t ShardedItemsNo(struct jaDictionary* dictionary);
+	void ShardedSetThresholds(struct jaDictionary* dictionary, unsigned grow, unsigned shrink);
+	void ShardedIterate(struct jaDictionary* dictionary, size_t workers_no,
+	                    void (*callback)(struct jaDictionaryItem*, void*), void* extra_data);
+
+	void* ArenaAlloc(struct Arena* arena, size_t size);
+	void ArenaDelete(struct Arena* arena);
+
+	int LinearHashingInit(struct jaDictionary* dictionary);
+	void LinearHashingDelete(struct jaDictionary* dictionary);
+	int LinearHashingAdd(struct jaDictionary* dictionary, struct jaDictionaryItem* item);
+	int LinearHashingReserve(struct jaDictionary* dictionary, size_t items_no);
+	struct jaDictionaryItem* LinearHashingGet(const struct jaDictionary* dictionary, const char* key, size_t size,
+	                                          uint64_t hash);
+	int LinearHashingDetach(struct jaDictionaryItem* item);
+	void LinearHashingIterate(struct jaDictionary* dictionary, void (*callback)(struct jaDictionaryItem*, void*),
+	                          void* extra_data);
+	size_t LinearHashingNext(struct jaDictionaryState* state, struct jaDictionaryItem** items, size_t items_no);
+	void LinearHashingStats(struct jaDictionary* dictionary, struct jaDictionaryStats* out);
+
+	int OpenAddressingInit(struct jaDictionary* dictionary);
+	void OpenAddressingDelete(struct jaDictionary* dictionary);
+	int OpenAddressingAdd(struct jaDictionary* dictionary, struct jaDictionaryItem* item);
+	int OpenAddressingReserve(struct jaDictionary* dictionary, size_t items_no);
+	struct jaDictionaryItem* OpenAddressingGet(const struct jaDictionary* dictionary, const char* key, size_t size,
+	                                           uint64_t hash);
+	int OpenAddressingDetach(struct jaDictionaryItem* item);
+	void OpenAddressingIterate(struct jaDictionary* dictionary, void (*callback)(struct jaDictionaryItem*, void*),
+	                           void* extra_data);
+	size_t OpenAddressingNext(struct jaDictionaryState* state, struct jaDictionaryItem** items, size_t items_no);
+	void OpenAddressingStats(struct jaDictionary* dictionary, struct jaDictionaryStats* out);
+
+#endif
@@ -0,0 +1,303 @@
+/*-----------------------------
+
+MIT License
+
+Copyright (c) 2019 Alexander Brandt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-------------------------------
+
+ [sharded.c]
+ - Alexander Brandt 2020
+
+ Independent tables, each behind its own lock, so writers of
+ different shards don't serialize on a single resize state.
+-----------------------------*/
+
+#include "private.h"
+
+
+struct Worker
+{
+	struct Sharded* sharded;
+	size_t* next_shard;
+
+	void (*callback)(struct jaDictionaryItem*, void*);
+	void* extra_data;
+};
+
+
+/*-----------------------------
+
+ sIterateShard()
+-----------------------------*/
+static void sIterateShard(struct Shard* shard, void (*callback)(struct jaDictionaryItem*, void*), void* extra_data)
+{
+	MutexLock(&shard->lock);
+
+	if (shard->dictionary.flags & JA_DICTIONARY_OPEN_ADDRESSING)
+		OpenAddressingIterate(&shard->dictionary, callback, extra_data);
+	else
+		LinearHashingIterate(&shard->dictionary, callback, extra_data);
+
+	MutexUnlock(&shard->lock);
+}
+
+
+/*-----------------------------
+
+ sWorker()
+-----------------------------*/
+static void sWorker(void* data)
+{
+	struct Worker* worker = data;
+	size_t i = 0;
+
+	// Shards are taken one at a time, until none remains
+	while ((i = AtomicAddSize(worker->next_shard, 1) - 1) < worker->sharded->shards_no)
+		sIterateShard(&worker->sharded->shard[i], worker->callback, worker->extra_data);
+}
+
+
+/*-----------------------------
+
+ sDeleteShard()
+-----------------------------*/
+static void sDeleteShard(struct Shard* shard)
+{
+	if (shard->dictionary.flags & JA_DICTIONARY_OPEN_ADDRESSING)
+		OpenAddressingDelete(&shard->dictionary);
+	else
+		LinearHashingDelete(&shard->dictionary);
+
+	if (shard->dictionary.flags & JA_DICTIONARY_ARENA)
+		ArenaDelete(&shard->dictionary.arena);
+
+	MutexDestroy(&shard->lock);
+}
+
+
+/*-----------------------------
+
+ ShardedInit()
+-----------------------------*/
+int ShardedInit(struct jaDictionary* dictionary, size_t shards_no)
+{
+	struct Sharded* sharded = NULL;
+	struct Shard* shard = NULL;
+	enum jaDictionaryFlags flags = dictionary->flags;
+	int bits = 0;
+	int error = 0;
+
+	while (((size_t)1 << bits) < shards_no && bits < 16)
+		bits += 1;
+
+	shards_no = (size_t)1 << bits;
+
+	if ((sharded = AllocateZero(dictionary->allocator, sizeof(struct Sharded) + sizeof(struct Shard) * shards_no)) ==
+	    NULL)
+		return 1;
+
+	flags &= (enum jaDictionaryFlags)(~JA_DICTIONARY_SHARDED);
+	sharded->shards_no = shards_no;
+	sharded->hash_shift = 57 - bits; // Right below the fingerprint
+
+	for (size_t i = 0; i < shards_no; i++)
+	{
+		shard = &sharded->shard[i];
+		shard->dictionary.flags = flags;
+		shard->dictionary.hash_function = dictionary->hash_function;
+		shard->dictionary.allocator = dictionary->allocator;
+		shard->dictionary.arena.allocator = dictionary->allocator;
+		shard->dictionary.seed[0] = dictionary->seed[0]; // Routing and tables hash the same way
+		shard->dictionary.seed[1] = dictionary->seed[1];
+
+		if (MutexInit(&shard->lock) != 0)
+			error = 1;
+		else
+		{
+			if (shard->dictionary.flags & JA_DICTIONARY_OPEN_ADDRESSING)
+				error = OpenAddressingInit(&shard->dictionary);
+			else
+				error = LinearHashingInit(&shard->dictionary);
+
+			if (error != 0)
+				MutexDestroy(&shard->lock);
+		}
+
+		if (error != 0)
+		{
+			while (i-- != 0)
+				sDeleteShard(&sharded->shard[i]);
+
+			Deallocate(dictionary->allocator, sharded);
+			return 1;
+		}
+
+		shard->dictionary.lock = &shard->lock;
+	}
+
+	dictionary->sharded = sharded;
+	return 0;
+}
+
+
+/*-----------------------------
+
+ ShardedDelete()
+-----------------------------*/
+void ShardedDelete(struct jaDictionary* dictionary)
+{
+	for (size_t i = 0; i < dictionary->sharded->shards_no; i++)
+		sDeleteShard(&dictionary->sharded->shard[i]);
+
+	Deallocate(dictionary->allocator, dictionary->sharded);
+	dictionary->sharded = NULL;
+}
+
+
+/*-----------------------------
+
+ ShardedReserve()
+-----------------------------*/
+int ShardedReserve(struct jaDictionary* dictionary, size_t items_no)
+{
+	struct Sharded* sharded = dictionary->sharded;
+	size_t per_shard = 0;
+	int error = 0;
+
+	// Hashes spread keys evenly, a small margin covers the variance
+	per_shard = items_no / sharded->shards_no;
+	per_shard += per_shard / 8 + 1;
+
+	for (size_t i = 0; i < sharded->shards_no; i++)
+	{
+		struct jaDictionary* shard = &sharded->shard[i].dictionary;
+
+		MutexLock(shard->lock);
+
+		if (shard->flags & JA_DICTIONARY_OPEN_ADDRESSING)
+			error |= OpenAddressingReserve(shard, per_shard);
+		else
+			error |= LinearHashingReserve(shard, per_shard);
+
+		MutexUnlock(shard->lock);
+	}
+
+	return error;
+}
+
+
+/*-----------------------------
+
+ ShardedItemsNo()
+-----------------------------*/
+size_t ShardedItemsNo(struct jaDictionary* dictionary)
+{
+	size_t items_no = 0;
+
+	for (size_t i = 0; i < dictionary->sharded->shards_no; i++)
+	{
+		struct jaDictionary* shard = &dictionary->sharded->shard[i].dictionary;
+
+		MutexLock(shard->lock);
+		items_no += shard->items_no;
+		MutexUnlock(shard->lock);
+	}
+
+	return items_no;
+}
+
+
+/*-----------------------------
+
+ ShardedStats()
+-----------------------------*/
+void ShardedStats(struct jaDictionary* dictionary, struct jaDictionaryStats* out)
+{
+	for (size_t i = 0; i < dictionary->sharded->shards_no; i++)
+	{
+		struct jaDictionary* shard = &dictionary->sharded->shard[i].dictionary;
+
+		MutexLock(shard->lock);
+		AddStats(shard, out);
+		MutexUnlock(shard->lock);
+	}
+
+	// Meaningless as a sum
+	out->level = 0;
+	out->pointer = 0;
+}
+
+
+/*-----------------------------
+
+ ShardedSetThresholds()
+-----------------------------*/
+void ShardedSetThresholds(struct jaDictionary* dictionary, unsigned grow, unsigned shrink)
+{
+	for (size_t i = 0; i < dictionary->sharded->shards_no; i++)
+	{
+		struct jaDictionary* shard = &dictionary->sharded->shard[i].dictionary;
+
+		MutexLock(shard->lock);
+		shard->grow_threshold = grow;
+		shard->shrink_threshold = shrink;
+		MutexUnlock(shard->lock);
+	}
+}
+
+
+/*-----------------------------
+
+ ShardedIterate()
+-----------------------------*/
+void ShardedIterate(struct jaDictionary* dictionary, size_t workers_no,
+                    void (*callback)(struct jaDictionaryItem*, void*), void* extra_data)
+{
+	struct Worker worker = {dictionary->sharded, NULL, callback, extra_data};
+	struct ThreadStart start = {sWorker, &worker};
+	Thread* threads = NULL;
+	size_t next_shard = 0;
+	size_t threads_no = 0;
+
+	worker.next_shard = &next_shard;
+
+	if (workers_no > dictionary->sharded->shards_no)
+		workers_no = dictionary->sharded->shards_no;
+
+	// The calling thread is also a worker, if we fail creating
+	// threads the ones that we have take the remaining shards
+	if (workers_no > 1 && (threads = Allocate(dictionary->allocator, sizeof(Thread) * (workers_no - 1))) != NULL)
+	{
+		for (; threads_no < workers_no - 1; threads_no++)
+		{
+			if (ThreadCreate(&threads[threads_no], &start) != 0)
+				break;
+		}
+	}
+
+	sWorker(&worker);
+
+	for (size_t i = 0; i < threads_no; i++)
+		ThreadJoin(threads[i]);
+
+	Deallocate(dictionary->allocator, threads);
+}
@@ -139,7 +139,7 @@ static int sReadCompressed_8(FILE* file, struct jaImage* image)
 	uint32_t* size_table = NULL;
 
 	// Offset and size tables of RLE scanlines
-	if ((buffer = malloc(sizeof(uint32_t) * table_len * 2)) == NULL)
+	if ((buffer = Allocate(image->allocator, sizeof(uint32_t) * table_len * 2)) == NULL)
 		return 1;
 
 	offset_table = (uint32_t*)buffer;
@@ -214,11 +214,11 @@ static int sReadCompressed_8(FILE* file, struct jaImage* image)
 	}
 
 	// Bye!
-	free(buffer);
+	Deallocate(image->allocator, buffer);
 	return 0;
 
 return_failure:
-	free(buffer);
+	Deallocate(image->allocator, buffer);
 	return 1;
 }
 
@@ -240,7 +240,7 @@ bool CheckMagicSgi(uint16_t value)
 
  ImageLoadSgi()
 -----------------------------*/
-struct jaImage* ImageLoadSgi(FILE* file, const char* filename, struct jaStatus* st)
+struct jaImage* ImageLoadSgi(FILE* file, const char* filename, const struct jaAllocator* allocator, struct jaStatus* st)
 {
 	struct jaImageEx ex = {0};
 	struct jaImage* image = NULL;
@@ -265,7 +265,7 @@ struct jaImage* ImageLoadSgi(FILE* file, const char* filename, struct jaStatus*
 		goto return_failure;
 	}
 
-	if ((image = jaImageCreate(ex.format, ex.width, ex.height, ex.channels)) == NULL)
+	if ((image = jaImageCreateWith(ex.format, ex.width, ex.height, ex.channels, JA_BUFFER_DEFAULT, allocator)) == NULL)
 	{
 		jaStatusSet(st, "ImageLoadSgi", JA_STATUS_MEMORY_ERROR, NULL);
 		goto return_failure;
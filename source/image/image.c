@@ -38,7 +38,8 @@ SOFTWARE.
 
 
 extern bool CheckMagicSgi(uint16_t value);
-extern struct jaImage* ImageLoadSgi(FILE* file, const char* filename, struct jaStatus* st);
+extern struct jaImage* ImageLoadSgi(FILE* file, const char* filename, const struct jaAllocator* allocator,
+                                    struct jaStatus* st);
 extern int ImageExLoadSgi(FILE* file, struct jaImageEx* out, struct jaStatus* st);
 
 
@@ -46,19 +47,60 @@ extern int ImageExLoadSgi(FILE* file, struct jaImageEx* out, struct jaStatus* st
 
  jaImageCreate()
 -----------------------------*/
-struct jaImage* jaImageCreate(enum jaImageFormat format, size_t width, size_t height, size_t channels)
+inline struct jaImage* jaImageCreate(enum jaImageFormat format, size_t width, size_t height, size_t channels)
+{
+	return jaImageCreateEx(format, width, height, channels, JA_BUFFER_DEFAULT);
+}
+
+
+/*-----------------------------
+
+ jaImageCreateEx()
+-----------------------------*/
+inline struct jaImage* jaImageCreateEx(enum jaImageFormat format, size_t width, size_t height, size_t channels,
+                                       enum jaBufferFlags flags)
+{
+	return jaImageCreateWith(format, width, height, channels, flags, NULL);
+}
+
+
+/*-----------------------------
+
+ jaImageCreateWith()
+-----------------------------*/
+struct jaImage* jaImageCreateWith(enum jaImageFormat format, size_t width, size_t height, size_t channels,
+                                  enum jaBufferFlags flags, const struct jaAllocator* allocator)
 {
 	struct jaImage* image = NULL;
+	struct jaBuffer* buffer = NULL;
 	size_t size = (size_t)(jaBitsPerComponent(format) / 8) * width * height * channels;
 
-	if ((image = malloc(sizeof(struct jaImage) + size)) != NULL)
+	// Data follows the image, or a buffer with it does
+	if ((image = Allocate(allocator,
+	                      sizeof(struct jaImage) + ((flags == JA_BUFFER_DEFAULT) ? size : sizeof(struct jaBuffer)))) ==
+	    NULL)
+		return NULL;
+
+	image->width = width;
+	image->height = height;
+	image->channels = channels;
+	image->format = format;
+	image->size = size;
+	image->data = ((struct jaImage*)image + 1);
+	image->allocator = allocator;
+
+	if (flags != JA_BUFFER_DEFAULT)
 	{
-		image->width = width;
-		image->height = height;
-		image->channels = channels;
-		image->format = format;
-		image->size = size;
-		image->data = ((struct jaImage*)image + 1);
+		buffer = image->data;
+		memset(buffer, 0, sizeof(struct jaBuffer));
+		buffer->flags = flags;
+		buffer->allocator = allocator;
+
+		if ((image->data = jaBufferReserve(buffer, (size != 0) ? size : 1)) == NULL)
+		{
+			Deallocate(allocator, image);
+			return NULL;
+		}
 	}
 
 	return image;
@@ -71,7 +113,13 @@ struct jaImage* jaImageCreate(enum jaImageFormat format, size_t width, size_t he
 -----------------------------*/
 inline void jaImageDelete(struct jaImage* image)
 {
-	free(image);
+	if (image != NULL)
+	{
+		if (image->data != ((struct jaImage*)image + 1))
+			jaBufferClean((struct jaBuffer*)((struct jaImage*)image + 1));
+
+		Deallocate(image->allocator, image);
+	}
 }
 
 
@@ -79,7 +127,17 @@ inline void jaImageDelete(struct jaImage* image)
 
  jaImageLoad()
 -----------------------------*/
-struct jaImage* jaImageLoad(const char* filename, struct jaStatus* st)
+inline struct jaImage* jaImageLoad(const char* filename, struct jaStatus* st)
+{
+	return jaImageLoadWith(filename, NULL, st);
+}
+
+
+/*-----------------------------
+
+ jaImageLoadWith()
+-----------------------------*/
+struct jaImage* jaImageLoadWith(const char* filename, const struct jaAllocator* allocator, struct jaStatus* st)
 {
 	FILE* file = NULL;
 	struct jaImage* image = NULL;
@@ -102,7 +160,7 @@ struct jaImage* jaImageLoad(const char* filename, struct jaStatus* st)
 	fseek(file, 0, SEEK_SET);
 
 	if (CheckMagicSgi(magic) == true)
-		image = ImageLoadSgi(file, filename, st);
+		image = ImageLoadSgi(file, filename, allocator, st);
 	// else if (CheckMagicBmp(magic) == true)
 	//	image = ImageLoadBmp(file, filename, st;
 	else
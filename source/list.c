@@ -28,17 +28,112 @@ SOFTWARE.
  - Alexander Brandt 2019-2020
 -----------------------------*/
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "common.h"
 #include "japan-list.h"
 
 
+#define INITIAL_CHUNK_SIZE (16 * 1024)
+#define MAX_CHUNK_SIZE (4 * 1024 * 1024)
+
+struct jaListChunk
+{
+	struct jaListChunk* next;
+	size_t size;
+	size_t used;
+};
+
+struct PoolSlot
+{
+	size_t capacity; // Of the data after the item
+	struct jaListItem item;
+};
+
+
+static struct jaListChunk* sNewChunk(struct jaList* list, size_t size)
+{
+	struct jaListChunk* chunk = NULL;
+
+	if ((chunk = Allocate(list->allocator, sizeof(struct jaListChunk) + size)) != NULL)
+	{
+		chunk->next = NULL;
+		chunk->size = size;
+		chunk->used = 0;
+	}
+
+	return chunk;
+}
+
+
+static struct jaListItem* sPoolAlloc(struct jaList* list, size_t data_size)
+{
+	struct jaListPool* pool = &list->pool;
+	struct jaListChunk* chunk = pool->actual;
+	struct jaListChunk* last = NULL;
+	struct PoolSlot* slot = NULL;
+	size_t size = 0;
+
+	// Removed items first, lists tend to have a single size of them
+	if (pool->spare_items != NULL)
+	{
+		slot = (struct PoolSlot*)((uint8_t*)pool->spare_items - offsetof(struct PoolSlot, item));
+
+		if (slot->capacity >= data_size)
+		{
+			pool->spare_items = slot->item.next;
+			return &slot->item;
+		}
+	}
+
+	// Otherwise the actual chunk, or the following ones kept by a Clear()
+	if (data_size > SIZE_MAX - sizeof(struct PoolSlot) - 8)
+		return NULL;
+
+	size = (sizeof(struct PoolSlot) + data_size + 7) & ~(size_t)7;
+
+	for (; chunk != NULL && chunk->size - chunk->used < size; chunk = chunk->next)
+		last = chunk;
+
+	if (chunk == NULL)
+	{
+		if (pool->chunk_size == 0)
+			pool->chunk_size = INITIAL_CHUNK_SIZE;
+
+		if ((chunk = sNewChunk(list, (size > pool->chunk_size) ? size : pool->chunk_size)) == NULL)
+			return NULL;
+
+		if (last != NULL)
+			last->next = chunk;
+		else
+			pool->first = chunk;
+
+		if (pool->chunk_size < MAX_CHUNK_SIZE)
+			pool->chunk_size *= 2;
+	}
+
+	pool->actual = chunk;
+
+	slot = (struct PoolSlot*)((uint8_t*)(chunk + 1) + chunk->used);
+	slot->capacity = size - sizeof(struct PoolSlot);
+	chunk->used += size;
+
+	return &slot->item;
+}
+
+
 static struct jaListItem* sAllocItem(struct jaList* list, void* data, size_t data_size)
 {
 	struct jaListItem* item = NULL;
 
-	if ((item = malloc(sizeof(struct jaListItem) + data_size)) == NULL)
+	if (list->flags & JA_LIST_POOLED)
+		item = sPoolAlloc(list, data_size);
+	else
+		item = Allocate(list->allocator, sizeof(struct jaListItem) + data_size);
+
+	if (item == NULL)
 		return NULL;
 
 	if (data_size == 0)
@@ -55,15 +150,57 @@ static struct jaListItem* sAllocItem(struct jaList* list, void* data, size_t dat
 	item->next = NULL;
 	item->previous = NULL;
 	item->callback_delete = NULL;
+	item->allocator = list->allocator;
+	item->pool = (list->flags & JA_LIST_POOLED) ? list : NULL;
 
 	return item;
 }
 
 
-inline void jaListClean(struct jaList* list)
+void jaListClean(struct jaList* list)
+{
+	struct jaListChunk* next = NULL;
+
+	jaListClear(list);
+
+	for (struct jaListChunk* chunk = list->pool.first; chunk != NULL; chunk = next)
+	{
+		next = chunk->next;
+		Deallocate(list->allocator, chunk);
+	}
+
+	list->pool.first = NULL;
+	list->pool.actual = NULL;
+	list->pool.chunk_size = 0;
+}
+
+
+void jaListClear(struct jaList* list)
 {
-	while (list->last != NULL)
-		jaListRemove(list->last); // NOLINT(clang-analyzer-unix.Malloc)
+	if ((list->flags & JA_LIST_POOLED) == 0)
+	{
+		while (list->last != NULL)
+			jaListRemove(list->last); // NOLINT(clang-analyzer-unix.Malloc)
+
+		return;
+	}
+
+	// Without unlinking nor freeing items, only callbacks need to visit them
+	for (struct jaListItem* item = list->first; item != NULL; item = item->next)
+	{
+		if (item->callback_delete != NULL)
+			item->callback_delete(item);
+	}
+
+	for (struct jaListChunk* chunk = list->pool.first; chunk != NULL; chunk = chunk->next)
+		chunk->used = 0;
+
+	list->pool.actual = list->pool.first;
+	list->pool.spare_items = NULL;
+
+	list->first = NULL;
+	list->last = NULL;
+	list->items_no = 0;
 }
 
 
@@ -153,7 +290,13 @@ void jaListRemove(struct jaListItem* item)
 	if (item->callback_delete != NULL)
 		item->callback_delete(item);
 
-	free(item);
+	if (item->pool == NULL)
+		Deallocate(item->allocator, item);
+	else
+	{
+		item->next = item->pool->pool.spare_items;
+		item->pool->pool.spare_items = item;
+	}
 }
 
 
@@ -213,3 +356,123 @@ struct jaListItem* jaListIterate(struct jaListState* state)
 	state->actual = to_return;
 	return to_return;
 }
+
+
+int jaNodeListAdd(struct jaNodeList* list, struct jaListNode* node)
+{
+	if (node->list != NULL)
+		return 1;
+
+	node->list = list;
+	node->next = NULL;
+	node->previous = list->last;
+
+	if (list->last != NULL)
+		list->last->next = node;
+	else
+		list->first = node;
+
+	list->last = node;
+	list->nodes_no += 1;
+
+	return 0;
+}
+
+
+int jaNodeListAddAfter(struct jaListNode* node, struct jaListNode* new_node)
+{
+	if (node->list == NULL || new_node->list != NULL)
+		return 1;
+
+	new_node->list = node->list;
+	new_node->previous = node;
+	new_node->next = node->next;
+
+	if (node->next != NULL)
+		node->next->previous = new_node;
+	else
+		node->list->last = new_node;
+
+	node->next = new_node;
+	node->list->nodes_no += 1;
+
+	return 0;
+}
+
+
+int jaNodeListAddBefore(struct jaListNode* node, struct jaListNode* new_node)
+{
+	if (node->list == NULL || new_node->list != NULL)
+		return 1;
+
+	new_node->list = node->list;
+	new_node->next = node;
+	new_node->previous = node->previous;
+
+	if (node->previous != NULL)
+		node->previous->next = new_node;
+	else
+		node->list->first = new_node;
+
+	node->previous = new_node;
+	node->list->nodes_no += 1;
+
+	return 0;
+}
+
+
+inline int jaNodeListRemove(struct jaListNode* node)
+{
+	if (node->list == NULL)
+		return 1;
+
+	if (node->previous == NULL)
+		node->list->first = node->next;
+	else
+		node->previous->next = node->next;
+
+	if (node->next == NULL)
+		node->list->last = node->previous;
+	else
+		node->next->previous = node->previous;
+
+	node->list->nodes_no -= 1;
+
+	node->next = NULL;
+	node->previous = NULL;
+	node->list = NULL;
+
+	return 0;
+}
+
+
+inline struct jaListNode* jaNodeListPop(struct jaNodeList* list)
+{
+	struct jaListNode* node = list->first;
+
+	if (node != NULL)
+		jaNodeListRemove(node);
+
+	return node;
+}
+
+
+struct jaListNode* jaNodeListIterate(struct jaNodeListState* state)
+{
+	struct jaListNode* to_return = NULL;
+
+	if (state->start != NULL)
+	{
+		to_return = state->start;
+		state->start = NULL;
+	}
+	else
+		to_return = state->future_return;
+
+	// Taken now, so the returned node can be removed
+	if (to_return != NULL)
+		state->future_return = (state->reverse == false) ? to_return->next : to_return->previous;
+
+	state->actual = to_return;
+	return to_return;
+}
@@ -99,19 +99,60 @@ int WritePcm(FILE* file, const struct jaSound* sound, enum jaEndianness dest_end
 
  jaSoundCreate()
 -----------------------------*/
-struct jaSound* jaSoundCreate(enum jaSoundFormat format, size_t length, size_t channels, size_t frequency)
+inline struct jaSound* jaSoundCreate(enum jaSoundFormat format, size_t length, size_t channels, size_t frequency)
+{
+	return jaSoundCreateEx(format, length, channels, frequency, JA_BUFFER_DEFAULT);
+}
+
+
+/*-----------------------------
+
+ jaSoundCreateEx()
+-----------------------------*/
+inline struct jaSound* jaSoundCreateEx(enum jaSoundFormat format, size_t length, size_t channels, size_t frequency,
+                                       enum jaBufferFlags flags)
+{
+	return jaSoundCreateWith(format, length, channels, frequency, flags, NULL);
+}
+
+
+/*-----------------------------
+
+ jaSoundCreateWith()
+-----------------------------*/
+struct jaSound* jaSoundCreateWith(enum jaSoundFormat format, size_t length, size_t channels, size_t frequency,
+                                  enum jaBufferFlags flags, const struct jaAllocator* allocator)
 {
 	struct jaSound* sound = NULL;
+	struct jaBuffer* buffer = NULL;
 	size_t size = (size_t)jaBytesPerSample(format) * length * channels;
 
-	if ((sound = malloc(sizeof(struct jaSound) + size)) != NULL)
+	// Data follows the sound, or a buffer with it does
+	if ((sound = Allocate(allocator,
+	                      sizeof(struct jaSound) + ((flags == JA_BUFFER_DEFAULT) ? size : sizeof(struct jaBuffer)))) ==
+	    NULL)
+		return NULL;
+
+	sound->frequency = frequency;
+	sound->channels = channels;
+	sound->length = length;
+	sound->size = size;
+	sound->format = format;
+	sound->data = ((struct jaSound*)sound + 1);
+	sound->allocator = allocator;
+
+	if (flags != JA_BUFFER_DEFAULT)
 	{
-		sound->frequency = frequency;
-		sound->channels = channels;
-		sound->length = length;
-		sound->size = size;
-		sound->format = format;
-		sound->data = ((struct jaSound*)sound + 1);
+		buffer = sound->data;
+		memset(buffer, 0, sizeof(struct jaBuffer));
+		buffer->flags = flags;
+		buffer->allocator = allocator;
+
+		if ((sound->data = jaBufferReserve(buffer, (size != 0) ? size : 1)) == NULL)
+		{
+			Deallocate(allocator, sound);
+			return NULL;
+		}
 	}
 
 	return sound;
@@ -124,7 +165,13 @@ struct jaSound* jaSoundCreate(enum jaSoundFormat format, size_t length, size_t c
 -----------------------------*/
 inline void jaSoundDelete(struct jaSound* sound)
 {
-	free(sound);
+	if (sound != NULL)
+	{
+		if (sound->data != ((struct jaSound*)sound + 1))
+			jaBufferClean((struct jaBuffer*)((struct jaSound*)sound + 1));
+
+		Deallocate(sound->allocator, sound);
+	}
 }
 
 
@@ -132,7 +179,17 @@ inline void jaSoundDelete(struct jaSound* sound)
 
  jaSoundLoad()
 -----------------------------*/
-struct jaSound* jaSoundLoad(const char* filename, struct jaStatus* st)
+inline struct jaSound* jaSoundLoad(const char* filename, struct jaStatus* st)
+{
+	return jaSoundLoadWith(filename, NULL, st);
+}
+
+
+/*-----------------------------
+
+ jaSoundLoadWith()
+-----------------------------*/
+struct jaSound* jaSoundLoadWith(const char* filename, const struct jaAllocator* allocator, struct jaStatus* st)
 {
 	FILE* file = NULL;
 	struct jaSoundEx ex = {0};
@@ -193,7 +250,7 @@ struct jaSound* jaSoundLoad(const char* filename, struct jaStatus* st)
 		goto return_failure;
 	}
 
-	if ((sound = jaSoundCreate(ex.format, ex.length, ex.channels, ex.frequency)) == NULL)
+	if ((sound = jaSoundCreateWith(ex.format, ex.length, ex.channels, ex.frequency, JA_BUFFER_DEFAULT, allocator)) == NULL)
 	{
 		jaStatusSet(st, "jaSoundLoad", JA_STATUS_MEMORY_ERROR, NULL);
 		goto return_failure;
@@ -211,15 +211,390 @@ static inline int sUTF8ValidateUnitSimple(const uint8_t* byte, const uint8_t* en
 }
 
 
+/*-----------------------------
+
+ Vectorized validation, of whole blocks as long as they are valid and without
+ a NULL. Returns the bytes validated, up to a unit boundary, adding its units,
+ and in 'stop' the end of the block where it stopped (trying again before it
+ would fail in the same place).
+ Callers give 'n' as a maximum for NULL terminated strings, so blocks are
+ aligned: they never cross a page, and reading past the NULL is safe (as
+ strlen() does) yet not for sanitizers. Bytes before the start are spaces.
+ Multi-byte units are checked with lookup tables from the high and low nibbles
+ of each byte and the previous one, as in: John Keiser, Daniel Lemire (2021).
+ Validating UTF-8 in less than one instruction per byte.
+-----------------------------*/
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define VECTORIZED_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TARGET_AVX2 // Whitespace
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VECTORIZED_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(VECTORIZED_X86) || defined(VECTORIZED_NEON)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define OVER_READ __attribute__((no_sanitize_address))
+#else
+#define OVER_READ // Whitespace
+#endif
+
+#define TOO_SHORT (1 << 0)  // 11______ 0_______, or 11______ 11______
+#define TOO_LONG (1 << 1)   // 0_______ 10______
+#define OVERLONG_3 (1 << 2) // 11100000 100_____
+#define TOO_LARGE (1 << 3)  // 11110100 1001____, 11110100 101_____, 11110101 1001____...
+#define SURROGATE (1 << 4)  // 11101101 101_____
+#define OVERLONG_2 (1 << 5) // 1100000_ 10______
+#define TOO_LARGE_1000 (1 << 6) // 11110101 1000____, 1111011_ 1000____, 11111___ 1000____
+#define OVERLONG_4 (1 << 6)     // 11110000 1000____
+#define TWO_CONTS (1 << 7)      // 10______ 10______
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+// Indexed by the high nibble of the previous byte
+static const uint8_t s_byte_1_high[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, // ASCII
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,                                     // Continuation
+    TOO_SHORT | OVERLONG_2,                                                         // 1100____
+    TOO_SHORT,                                                                      // 1101____
+    TOO_SHORT | OVERLONG_3 | SURROGATE,                                             // 1110____
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4                             // 1111____
+};
+
+// By the low nibble of the previous byte
+static const uint8_t s_byte_1_low[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,    // ____0000
+    CARRY | OVERLONG_2,                              // ____0001
+    CARRY,                                           // ____0010
+    CARRY,                                           // ____0011
+    CARRY | TOO_LARGE,                               // ____0100
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____0101
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____0110
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____0111
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1000
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1001
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1010
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1011
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1100
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,  // ____1101
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1110
+    CARRY | TOO_LARGE | TOO_LARGE_1000               // ____1111
+};
+
+// By the high nibble of the actual byte
+static const uint8_t s_byte_2_high[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, // ASCII
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,           // 1000____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,                             // 1001____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,                              // 1010____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,                              // 1011____
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT                                              // 11______
+};
+
+// Units heads at the end, that go beyond the last byte. Never the first one
+static const uint8_t s_incomplete[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1};
+
+// From 32 - head, a mask of the bytes before the start
+static const uint8_t s_before[64] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+
+static inline size_t sIncompleteTail(const uint8_t* string, size_t validated)
+{
+	// Bytes of the last unit of a validated block, when it continues in the next one
+	for (size_t i = 1; i <= 3 && i <= validated; i++)
+	{
+		if ((string[validated - i] & 0xC0) != 0x80) // Not a tail byte
+			return (jaUnitLengthUTF8(string[validated - i]) > i) ? i : 0;
+	}
+
+	return 0;
+}
+
+
+static inline size_t sBoundary(const uint8_t* aligned, size_t head, size_t validated, size_t* units)
+{
+	size_t tail = 0;
+
+	if (validated == 0)
+		return 0;
+
+	if ((tail = sIncompleteTail(aligned, validated)) != 0)
+		*units -= 1; // Its head was counted
+
+	return validated - tail - head;
+}
+
+#endif
+
+
+#if defined(VECTORIZED_X86)
+OVER_READ static size_t sValidateSSE2(const uint8_t* string, size_t n, size_t* units, size_t* stop)
+{
+	// Only an ASCII fast path, as without SSSE3 there are no lookups
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i spaces = _mm_set1_epi8(0x20);
+	size_t head = (uintptr_t)string % 16;
+	const uint8_t* aligned = string - head;
+	size_t i = 0;
+
+	for (n += head; i + 16 <= n; i += 16)
+	{
+		__m128i input = _mm_load_si128((const __m128i*)(aligned + i));
+
+		if (i == 0)
+		{
+			__m128i before = _mm_loadu_si128((const __m128i*)(s_before + 32 - head));
+			input = _mm_or_si128(_mm_and_si128(before, spaces), _mm_andnot_si128(before, input));
+		}
+
+		if ((_mm_movemask_epi8(input) | _mm_movemask_epi8(_mm_cmpeq_epi8(input, zero))) != 0)
+			break;
+	}
+
+	*stop = ((i + 16 <= n) ? i + 16 : n) - head;
+
+	if (i == 0)
+		return 0;
+
+	*units += i - head;
+	return i - head;
+}
+
+
+TARGET_AVX2 static inline __m256i sPrevAVX2(__m256i input, __m256i prev_input, int n)
+{
+	// Shifted 'n' bytes, those from the end of 'prev_input' coming in
+	__m256i crossed = _mm256_permute2x128_si256(prev_input, input, 0x21);
+
+	switch (n)
+	{
+	case 1: return _mm256_alignr_epi8(input, crossed, 15);
+	case 2: return _mm256_alignr_epi8(input, crossed, 14);
+	default: return _mm256_alignr_epi8(input, crossed, 13);
+	}
+}
+
+
+OVER_READ TARGET_AVX2 static size_t sValidateAVX2(const uint8_t* string, size_t n, size_t* units, size_t* stop)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i spaces = _mm256_set1_epi8(0x20);
+	const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+	const __m256i byte_1_high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)s_byte_1_high));
+	const __m256i byte_1_low = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)s_byte_1_low));
+	const __m256i byte_2_high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)s_byte_2_high));
+	const __m256i incomplete = _mm256_loadu_si256((const __m256i*)s_incomplete);
+
+	__m256i prev_input = zero; // As ASCII, we start at a unit boundary
+	__m256i prev_incomplete = zero;
+	__m256i error = zero;
+	__m256i heads = zero;
+	size_t head = (uintptr_t)string % 32;
+	const uint8_t* aligned = string - head;
+	size_t i = 0;
+
+	for (n += head; i + 32 <= n; i += 32)
+	{
+		__m256i input = _mm256_load_si256((const __m256i*)(aligned + i));
+
+		if (i == 0)
+			input = _mm256_blendv_epi8(input, spaces, _mm256_loadu_si256((const __m256i*)(s_before + 32 - head)));
+
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(input, zero)) != 0)
+			break;
+
+		if (_mm256_movemask_epi8(input) == 0)
+		{
+			error = prev_incomplete;
+			prev_incomplete = zero;
+		}
+		else
+		{
+			__m256i prev1 = sPrevAVX2(input, prev_input, 1);
+
+			// Special cases, in pairs of bytes
+			__m256i special = _mm256_and_si256(
+			    _mm256_and_si256(
+			        _mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble)),
+			        _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, low_nibble))),
+			    _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble)));
+
+			// Third and fourth bytes, only 111_____ and 1111____ heads saturate above 0x7F
+			__m256i must_be_tail = _mm256_or_si256(
+			    _mm256_subs_epu8(sPrevAVX2(input, prev_input, 2), _mm256_set1_epi8((char)(0xE0 - 0x80))),
+			    _mm256_subs_epu8(sPrevAVX2(input, prev_input, 3), _mm256_set1_epi8((char)(0xF0 - 0x80))));
+
+			error = _mm256_xor_si256(_mm256_and_si256(must_be_tail, _mm256_set1_epi8((char)0x80)), special);
+			prev_incomplete = _mm256_subs_epu8(input, incomplete);
+		}
+
+		if (_mm256_testz_si256(error, error) == 0)
+			break;
+
+		prev_input = input;
+
+		// Units are bytes that aren't tails, as signed above 0xBF
+		heads = _mm256_cmpgt_epi8(input, _mm256_set1_epi8(-65));
+		*units += (size_t)_mm_popcnt_u32((unsigned)_mm256_movemask_epi8(heads)) - ((i == 0) ? head : 0);
+	}
+
+	*stop = ((i + 32 <= n) ? i + 32 : n) - head;
+	return sBoundary(aligned, head, i, units);
+}
+
+
+static inline int sHasAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	static int has_avx2 = -1; // Same value from every thread
+	int info[4];
+
+	if (has_avx2 < 0)
+	{
+		has_avx2 = 0;
+		__cpuid(info, 0);
+
+		if (info[0] >= 7)
+		{
+			__cpuid(info, 1);
+
+			// Also enabled by the OS (OSXSAVE, and XMM/YMM states saved)
+			if ((info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x06) == 0x06)
+			{
+				__cpuidex(info, 7, 0);
+				has_avx2 = ((info[1] & (1 << 5)) != 0) ? 1 : 0;
+			}
+		}
+	}
+
+	return has_avx2;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+
+#if defined(VECTORIZED_NEON)
+OVER_READ static size_t sValidateNEON(const uint8_t* string, size_t n, size_t* units, size_t* stop)
+{
+	const uint8x16_t low_nibble = vdupq_n_u8(0x0F);
+	const uint8x16_t byte_1_high = vld1q_u8(s_byte_1_high);
+	const uint8x16_t byte_1_low = vld1q_u8(s_byte_1_low);
+	const uint8x16_t byte_2_high = vld1q_u8(s_byte_2_high);
+	const uint8x16_t incomplete = vld1q_u8(s_incomplete + 16);
+
+	uint8x16_t prev_input = vdupq_n_u8(0);
+	uint8x16_t prev_incomplete = vdupq_n_u8(0);
+	uint8x16_t error = vdupq_n_u8(0);
+	uint8x16_t heads = vdupq_n_u8(0);
+	size_t head = (uintptr_t)string % 16;
+	const uint8_t* aligned = string - head;
+	size_t i = 0;
+
+	for (n += head; i + 16 <= n; i += 16)
+	{
+		uint8x16_t input = vld1q_u8(aligned + i);
+
+		if (i == 0)
+			input = vbslq_u8(vld1q_u8(s_before + 32 - head), vdupq_n_u8(0x20), input);
+
+		if (vminvq_u8(input) == 0)
+			break;
+
+		if (vmaxvq_u8(input) < 0x80)
+		{
+			error = prev_incomplete;
+			prev_incomplete = vdupq_n_u8(0);
+		}
+		else
+		{
+			uint8x16_t prev1 = vextq_u8(prev_input, input, 15);
+
+			uint8x16_t special = vandq_u8(vandq_u8(vqtbl1q_u8(byte_1_high, vshrq_n_u8(prev1, 4)),
+			                                       vqtbl1q_u8(byte_1_low, vandq_u8(prev1, low_nibble))),
+			                              vqtbl1q_u8(byte_2_high, vshrq_n_u8(input, 4)));
+
+			uint8x16_t must_be_tail = vorrq_u8(vqsubq_u8(vextq_u8(prev_input, input, 14), vdupq_n_u8(0xE0 - 0x80)),
+			                                   vqsubq_u8(vextq_u8(prev_input, input, 13), vdupq_n_u8(0xF0 - 0x80)));
+
+			error = veorq_u8(vandq_u8(must_be_tail, vdupq_n_u8(0x80)), special);
+			prev_incomplete = vqsubq_u8(input, incomplete);
+		}
+
+		if (vmaxvq_u8(error) != 0)
+			break;
+
+		prev_input = input;
+		heads = vshrq_n_u8(vcgtq_s8(vreinterpretq_s8_u8(input), vdupq_n_s8(-65)), 7);
+		*units += vaddvq_u8(heads) - ((i == 0) ? head : 0);
+	}
+
+	*stop = ((i + 16 <= n) ? i + 16 : n) - head;
+	return sBoundary(aligned, head, i, units);
+}
+#endif
+
+
+static inline size_t sValidateBlocks(const uint8_t* string, size_t n, size_t* units, size_t* stop)
+{
+#if defined(VECTORIZED_X86) || defined(VECTORIZED_NEON)
+	if (n > SIZE_MAX / 2)
+		n = SIZE_MAX / 2; // Room for the alignment
+#endif
+
+#if defined(VECTORIZED_X86)
+	if (n >= 32 && sHasAVX2() != 0)
+		return sValidateAVX2(string, n, units, stop);
+
+	return sValidateSSE2(string, n, units, stop);
+#elif defined(VECTORIZED_NEON)
+	return sValidateNEON(string, n, units, stop);
+#else
+	(void)string;
+	(void)units;
+	*stop = n;
+	return 0;
+#endif
+}
+
+
 int jaStringValidateUTF8(const uint8_t* string, size_t n, size_t* out_bytes, size_t* out_units)
 {
 	size_t bytes = 0;
 	size_t units = 0;
 
 	size_t unit_lenght = 0;
+	const uint8_t* retry = string; // Where vectorized validation can go again
+	size_t stop = 0;
 
 	for (const uint8_t* string_end = (string + n); string < string_end; string++)
 	{
+		// Vectorized while it can, then a unit at a time past where it stopped
+		if (string >= retry)
+		{
+			unit_lenght = sValidateBlocks(string, (size_t)(string_end - string), &units, &stop);
+			retry = string + stop;
+			bytes += unit_lenght;
+
+			if ((string += unit_lenght) == string_end)
+				break;
+		}
+
 		if (sUTF8ValidateUnitSimple(string, string_end, &unit_lenght) != 0)
 			break;
 
@@ -246,3 +621,79 @@ int jaStringValidateUTF8(const uint8_t* string, size_t n, size_t* out_bytes, siz
 
 	return 1;
 }
+
+
+int jaStringValidateView(struct jaBufferView string, enum jaEncode encode, size_t* out_units)
+{
+	const uint8_t* s = string.data;
+	const uint8_t* string_end = s + string.size;
+
+	size_t unit_lenght = 1;
+	size_t units = 0;
+	int ret = 0;
+
+	const uint8_t* retry = s;
+	size_t stop = 0;
+
+	for (; s < string_end; s += unit_lenght)
+	{
+		if (encode == JA_UTF8)
+		{
+			// As in ValidateUTF8()
+			if (s >= retry)
+			{
+				unit_lenght = sValidateBlocks(s, (size_t)(string_end - s), &units, &stop);
+				retry = s + stop;
+
+				if ((s += unit_lenght) == string_end)
+					break;
+			}
+
+			ret = sUTF8ValidateUnitSimple(s, string_end, &unit_lenght);
+		}
+		else
+			ret = jaUnitValidateASCII(*s);
+
+		if (ret != 0)
+			break;
+
+		units += 1;
+	}
+
+	if (out_units != NULL)
+		*out_units = units; // Valid units so far
+
+	return ret;
+}
+
+
+static inline int sIsWhitespace(uint8_t byte)
+{
+	return (byte == 0x20 || byte == 0x09 || byte == 0x0A || byte == 0x0D) ? 1 : 0; // SPACE, TAB, LF, CR
+}
+
+
+struct jaBufferView jaStringTrim(struct jaBufferView string)
+{
+	const uint8_t* s = string.data;
+	size_t start = 0;
+	size_t end = string.size;
+
+	while (start < end && sIsWhitespace(s[start]) == 1)
+		start += 1;
+
+	while (end > start && sIsWhitespace(s[end - 1]) == 1)
+		end -= 1;
+
+	return jaBufferViewSlice(string, start, end - start);
+}
+
+
+struct jaBufferView jaStringSplit(struct jaBufferView* string, uint8_t delimiter)
+{
+	size_t i = jaBufferViewFind(*string, delimiter);
+	struct jaBufferView before = jaBufferViewSlice(*string, 0, i);
+
+	*string = jaBufferViewSlice(*string, i + 1, string->size);
+	return before;
+}
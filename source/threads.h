@@ -0,0 +1,155 @@
+/*-----------------------------
+
+ [threads.h]
+ - Alexander Brandt 2020
+
+ Threads, mutexes and the few atomic operations that we need,
+ over Pthreads/GCC builtins or Win32/Interlocked functions
+-----------------------------*/
+
+#ifndef JA_THREADS_H
+#define JA_THREADS_H
+
+	#include <stddef.h>
+	#include <stdint.h>
+
+	struct ThreadStart
+	{
+		void (*function)(void*);
+		void* data;
+	};
+
+	#if defined(_WIN32)
+		#define WIN32_LEAN_AND_MEAN
+		#include <windows.h>
+
+		#define THREAD_LOCAL __declspec(thread)
+
+		typedef HANDLE Thread;
+		typedef SRWLOCK Mutex;
+
+		static inline DWORD WINAPI ThreadTrampoline(LPVOID start)
+		{
+			((struct ThreadStart*)start)->function(((struct ThreadStart*)start)->data);
+			return 0;
+		}
+
+		static inline int ThreadCreate(Thread* thread, struct ThreadStart* start)
+		{
+			return ((*thread = CreateThread(NULL, 0, ThreadTrampoline, start, 0, NULL)) != NULL) ? 0 : 1;
+		}
+
+		static inline void ThreadJoin(Thread thread)
+		{
+			WaitForSingleObject(thread, INFINITE);
+			CloseHandle(thread);
+		}
+
+		static inline int MutexInit(Mutex* mutex)
+		{
+			InitializeSRWLock(mutex);
+			return 0;
+		}
+
+		static inline void MutexDestroy(Mutex* mutex) { (void)mutex; }
+		static inline void MutexLock(Mutex* mutex) { AcquireSRWLockExclusive(mutex); }
+		static inline void MutexUnlock(Mutex* mutex) { ReleaseSRWLockExclusive(mutex); }
+		static inline void ThreadYield() { SwitchToThread(); }
+	#else
+		#include <pthread.h>
+		#include <sched.h>
+
+		#define THREAD_LOCAL __thread
+
+		typedef pthread_t Thread;
+		typedef pthread_mutex_t Mutex;
+
+		static inline void* ThreadTrampoline(void* start)
+		{
+			((struct ThreadStart*)start)->function(((struct ThreadStart*)start)->data);
+			return NULL;
+		}
+
+		static inline int ThreadCreate(Thread* thread, struct ThreadStart* start)
+		{
+			return (pthread_create(thread, NULL, ThreadTrampoline, start) == 0) ? 0 : 1;
+		}
+
+		static inline void ThreadJoin(Thread thread) { pthread_join(thread, NULL); }
+
+		static inline int MutexInit(Mutex* mutex) { return (pthread_mutex_init(mutex, NULL) == 0) ? 0 : 1; }
+		static inline void MutexDestroy(Mutex* mutex) { pthread_mutex_destroy(mutex); }
+		static inline void MutexLock(Mutex* mutex) { pthread_mutex_lock(mutex); }
+		static inline void MutexUnlock(Mutex* mutex) { pthread_mutex_unlock(mutex); }
+		static inline void ThreadYield() { sched_yield(); }
+	#endif
+
+	// Loads are acquire, stores release, and operations on sizes
+	// sequentially consistent (as they are used for counters/epochs)
+	#if defined(_MSC_VER) && !defined(__clang__)
+		// Volatile accesses have acquire/release semantics under /volatile:ms,
+		// the default on x86 and x64, the only targets where MSVC uses it
+		#include <intrin.h>
+
+		static inline uint8_t AtomicLoadU8(const uint8_t* ptr) { return *(const volatile uint8_t*)ptr; }
+		static inline void AtomicStoreU8(uint8_t* ptr, uint8_t value) { *(volatile uint8_t*)ptr = value; }
+		static inline void* AtomicLoadPtr(void* const* ptr) { return *(void* const volatile*)ptr; }
+		static inline void AtomicStorePtr(void** ptr, void* value) { *(void* volatile*)ptr = value; }
+
+		#if defined(_WIN64)
+			#define INTERLOCKED_SIZE __int64
+			#define INTERLOCKED(name) name##64
+		#else
+			#define INTERLOCKED_SIZE long
+			#define INTERLOCKED(name) name
+		#endif
+
+		static inline size_t AtomicLoadSize(const size_t* ptr)
+		{
+			return (size_t)INTERLOCKED(_InterlockedCompareExchange)((volatile INTERLOCKED_SIZE*)ptr, 0, 0);
+		}
+
+		static inline void AtomicStoreSize(size_t* ptr, size_t value)
+		{
+			INTERLOCKED(_InterlockedExchange)((volatile INTERLOCKED_SIZE*)ptr, (INTERLOCKED_SIZE)value);
+		}
+
+		static inline size_t AtomicAddSize(size_t* ptr, size_t value) // Returns the new value
+		{
+			return (size_t)INTERLOCKED(_InterlockedExchangeAdd)((volatile INTERLOCKED_SIZE*)ptr,
+			                                                    (INTERLOCKED_SIZE)value) + value;
+		}
+
+		static inline size_t AtomicSubSize(size_t* ptr, size_t value) // "
+		{
+			return AtomicAddSize(ptr, (size_t)0 - value);
+		}
+	#else
+		static inline uint8_t AtomicLoadU8(const uint8_t* ptr) { return __atomic_load_n(ptr, __ATOMIC_ACQUIRE); }
+		static inline void AtomicStoreU8(uint8_t* ptr, uint8_t value)
+		{
+			__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+		}
+
+		static inline void* AtomicLoadPtr(void* const* ptr) { return __atomic_load_n(ptr, __ATOMIC_ACQUIRE); }
+		static inline void AtomicStorePtr(void** ptr, void* value) { __atomic_store_n(ptr, value, __ATOMIC_RELEASE); }
+
+		static inline size_t AtomicLoadSize(const size_t* ptr) { return __atomic_load_n(ptr, __ATOMIC_SEQ_CST); }
+
+		static inline void AtomicStoreSize(size_t* ptr, size_t value)
+		{
+			__atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+		}
+
+		static inline size_t AtomicAddSize(size_t* ptr, size_t value) // Returns the new value
+		{
+			return __atomic_add_fetch(ptr, value, __ATOMIC_SEQ_CST);
+		}
+
+		static inline size_t AtomicSubSize(size_t* ptr, size_t value) // "
+		{
+			return __atomic_sub_fetch(ptr, value, __ATOMIC_SEQ_CST);
+		}
+	#endif
+
+#endif
@@ -0,0 +1,463 @@
+/*-----------------------------
+
+MIT License
+
+Copyright (c) 2019 Alexander Brandt
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-------------------------------
+
+ [tree-parallel.c]
+ - Alexander Brandt 2020
+
+ Work-stealing over subtrees. Workers walk their task in
+ pre-order, and when someone is hungry hand it the next subtree
+ (with the value of its parent) through their deque.
+-----------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "japan-tree.h"
+#include "threads.h"
+
+
+#define VALUE_ALIGNMENT 16 // Of values stored in buffers
+#define TASK_HEADER VALUE_ALIGNMENT
+
+struct Deque
+{
+	Mutex lock;
+	struct jaBuffer tasks; // Records of a node and the value of its parent
+	size_t top;            // Where thieves take
+	size_t bottom;         // Where the owner pushes and takes
+	size_t length;         // Atomic, to peek without the lock
+};
+
+struct Shared
+{
+	struct Worker* worker;
+	size_t workers_no;
+
+	size_t pending; // Atomic, tasks pushed and not finished
+	size_t hungry;  // Atomic, workers without a task
+	size_t failed;  // Atomic
+
+	void (*callback)(struct jaTree*, const void*, void*, void*); // NULL to delete
+	void* extra_data;
+	size_t value_size;
+	size_t value_stride;
+	size_t task_size;
+};
+
+struct Worker
+{
+	struct Shared* shared;
+	size_t index;
+
+	struct Deque deque;
+	struct jaBuffer values; // Accumulated ones, the first of them from the parent of the task
+
+	Thread thread;
+	struct ThreadStart start;
+};
+
+
+static inline size_t sAligned(size_t size)
+{
+	return ((size + VALUE_ALIGNMENT - 1) / VALUE_ALIGNMENT) * VALUE_ALIGNMENT;
+}
+
+
+static inline void* sValue(const struct Worker* worker, size_t slot)
+{
+	return (worker->shared->value_stride == 0) ? NULL
+	                                           : (uint8_t*)worker->values.data + worker->shared->value_stride * slot;
+}
+
+
+/*-----------------------------
+
+ sPush()
+-----------------------------*/
+static int sPush(struct Worker* worker, struct jaTree* tree, const void* value)
+{
+	struct Deque* deque = &worker->deque;
+	uint8_t* record = NULL;
+	size_t task_size = worker->shared->task_size;
+
+	MutexLock(&deque->lock);
+
+	if (jaBufferResize(&deque->tasks, (deque->bottom + 1) * task_size) == NULL)
+	{
+		MutexUnlock(&deque->lock);
+		return 1;
+	}
+
+	record = (uint8_t*)deque->tasks.data + deque->bottom * task_size;
+	memcpy(record, &tree, sizeof(struct jaTree*));
+
+	if (value != NULL)
+		memcpy(record + TASK_HEADER, value, worker->shared->value_size);
+	else
+		memset(record + TASK_HEADER, 0, worker->shared->value_size);
+
+	// Pending before it is visible, so no one sees zero with it around
+	AtomicAddSize(&worker->shared->pending, 1);
+	deque->bottom += 1;
+	AtomicStoreSize(&deque->length, deque->bottom - deque->top);
+
+	MutexUnlock(&deque->lock);
+	return 0;
+}
+
+
+/*-----------------------------
+
+ sTake()
+-----------------------------*/
+static struct jaTree* sTakeFrom(struct Worker* worker, struct Deque* deque, bool steal)
+{
+	struct jaTree* tree = NULL;
+	uint8_t* record = NULL;
+	size_t task_size = worker->shared->task_size;
+
+	if (AtomicLoadSize(&deque->length) == 0)
+		return NULL;
+
+	MutexLock(&deque->lock);
+
+	if (deque->top != deque->bottom)
+	{
+		if (steal == true)
+			record = (uint8_t*)deque->tasks.data + (deque->top++) * task_size;
+		else
+			record = (uint8_t*)deque->tasks.data + (--deque->bottom) * task_size;
+
+		memcpy(&tree, record, sizeof(struct jaTree*));
+		if (task_size > TASK_HEADER)
+			memcpy(worker->values.data, record + TASK_HEADER, task_size - TASK_HEADER);
+
+		if (deque->top == deque->bottom)
+		{
+			deque->top = 0;
+			deque->bottom = 0;
+		}
+
+		AtomicStoreSize(&deque->length, deque->bottom - deque->top);
+	}
+
+	MutexUnlock(&deque->lock);
+	return tree;
+}
+
+static struct jaTree* sTake(struct Worker* worker)
+{
+	struct jaTree* tree = NULL;
+	size_t workers_no = worker->shared->workers_no;
+
+	// Own tasks first, newer ones
+	if ((tree = sTakeFrom(worker, &worker->deque, false)) != NULL)
+		return tree;
+
+	// Then older ones from others, more likely to be big subtrees
+	for (size_t i = 1; i < workers_no; i++)
+	{
+		if ((tree = sTakeFrom(worker, &worker->shared->worker[(worker->index + i) % workers_no].deque, true)) != NULL)
+			return tree;
+	}
+
+	return NULL;
+}
+
+
+/*-----------------------------
+
+ sWalk()
+-----------------------------*/
+static inline bool sSplit(struct Worker* worker)
+{
+	// A task at a time, while someone is hungry
+	return (AtomicLoadSize(&worker->shared->hungry) != 0 && AtomicLoadSize(&worker->deque.length) == 0) ? true
+	                                                                                                       : false;
+}
+
+
+static inline int sEnter(struct Worker* worker, struct jaTree* tree, size_t depth)
+{
+	if (worker->shared->callback == NULL)
+		return 0;
+
+	if (worker->shared->value_stride != 0 &&
+	    jaBufferResize(&worker->values, (depth + 2) * worker->shared->value_stride) == NULL)
+		return 1;
+
+	worker->shared->callback(tree, sValue(worker, depth), sValue(worker, depth + 1), worker->shared->extra_data);
+	return 0;
+}
+
+
+static inline void sLeave(struct Worker* worker, struct jaTree* tree)
+{
+	if (worker->shared->callback != NULL)
+		return;
+
+	if (tree->callback_delete != NULL)
+		tree->callback_delete(tree);
+
+	Deallocate(tree->allocator, tree);
+}
+
+
+static int sWalk(struct Worker* worker, struct jaTree* root)
+{
+	// Stackless, as jaTreeIterateNext(). Links of a node are read before handing or
+	// deleting it, and 'root' ones never, as its parent may be gone
+	struct jaTree* tree = root;
+	struct jaTree* next = NULL;
+	struct jaTree* parent = NULL;
+	size_t depth = 0;
+	bool handed = false;
+
+	if (sEnter(worker, tree, depth) != 0)
+		return 1;
+
+	for (;;)
+	{
+		// Childrens
+		if (handed == false && tree->children != NULL)
+		{
+			tree = tree->children;
+			depth += 1;
+		}
+
+		// Leaving it, then its parents without brothers
+		else
+		{
+			for (;;)
+			{
+				if (tree == root)
+				{
+					sLeave(worker, tree);
+					return 0;
+				}
+
+				if (handed == false)
+				{
+					next = tree->next;
+					parent = tree->parent;
+					sLeave(worker, tree);
+				}
+
+				handed = false;
+
+				if (next != NULL)
+				{
+					tree = next;
+					break;
+				}
+
+				tree = parent;
+				depth -= 1;
+			}
+		}
+
+		// Hand it, or enter it
+		if (sSplit(worker) == true)
+		{
+			next = tree->next;
+			parent = tree->parent;
+
+			if (sPush(worker, tree, sValue(worker, depth)) == 0)
+			{
+				handed = true;
+				continue;
+			}
+		}
+
+		if (sEnter(worker, tree, depth) != 0)
+			return 1;
+	}
+}
+
+
+/*-----------------------------
+
+ sWorker()
+-----------------------------*/
+static void sWorker(void* data)
+{
+	struct Worker* worker = data;
+	struct Shared* shared = worker->shared;
+	struct jaTree* tree = NULL;
+	bool hungry = false;
+
+	while (AtomicLoadSize(&shared->pending) != 0)
+	{
+		if ((tree = sTake(worker)) == NULL)
+		{
+			if (hungry == false)
+			{
+				AtomicAddSize(&shared->hungry, 1);
+				hungry = true;
+			}
+
+			ThreadYield();
+			continue;
+		}
+
+		if (hungry == true)
+		{
+			AtomicSubSize(&shared->hungry, 1);
+			hungry = false;
+		}
+
+		if (sWalk(worker, tree) != 0)
+			AtomicStoreSize(&shared->failed, 1);
+
+		AtomicSubSize(&shared->pending, 1);
+	}
+
+	if (hungry == true)
+		AtomicSubSize(&shared->hungry, 1);
+}
+
+
+/*-----------------------------
+
+ sRun()
+-----------------------------*/
+static int sRun(struct Shared* shared, struct jaTree* tree, size_t workers_no, const void* value)
+{
+	const struct jaAllocator* allocator = tree->allocator; // As 'tree' may be deleted
+	struct Worker single = {0};
+	struct Worker* worker = NULL;
+	size_t ready_no = 0;
+	size_t threads_no = 0;
+	int ret = 1;
+
+	shared->value_stride = sAligned(shared->value_size);
+	shared->task_size = TASK_HEADER + shared->value_stride;
+
+	// The calling thread is also a worker, alone if we fail allocating others
+	if (workers_no > 1 && (worker = AllocateZero(allocator, sizeof(struct Worker) * workers_no)) == NULL)
+		workers_no = 1;
+
+	if (workers_no <= 1)
+	{
+		worker = &single;
+		workers_no = 1;
+	}
+
+	shared->worker = worker;
+	shared->workers_no = workers_no;
+
+	for (; ready_no < workers_no; ready_no++)
+	{
+		worker[ready_no].shared = shared;
+		worker[ready_no].index = ready_no;
+		worker[ready_no].start.function = sWorker;
+		worker[ready_no].start.data = &worker[ready_no];
+		worker[ready_no].values.allocator = allocator;
+		worker[ready_no].deque.tasks.allocator = allocator;
+
+		if (shared->value_stride != 0 && jaBufferResize(&worker[ready_no].values, shared->value_stride * 2) == NULL)
+			goto cleanup;
+
+		if (MutexInit(&worker[ready_no].deque.lock) != 0)
+		{
+			jaBufferClean(&worker[ready_no].values);
+			goto cleanup;
+		}
+	}
+
+	if (sPush(&worker[0], tree, value) != 0)
+		goto cleanup;
+
+	// If we fail creating threads, the ones that we have do everything
+	for (threads_no = 1; threads_no < workers_no; threads_no++)
+	{
+		if (ThreadCreate(&worker[threads_no].thread, &worker[threads_no].start) != 0)
+			break;
+	}
+
+	sWorker(&worker[0]);
+
+	for (size_t i = 1; i < threads_no; i++)
+		ThreadJoin(worker[i].thread);
+
+	ret = (AtomicLoadSize(&shared->failed) == 0) ? 0 : 1;
+
+cleanup:
+	for (size_t i = 0; i < ready_no; i++)
+	{
+		MutexDestroy(&worker[i].deque.lock);
+		jaBufferClean(&worker[i].deque.tasks);
+		jaBufferClean(&worker[i].values);
+	}
+
+	if (worker != &single)
+		Deallocate(allocator, worker);
+
+	return ret;
+}
+
+
+/*-----------------------------
+
+ jaTreeIterateParallel()
+-----------------------------*/
+int jaTreeIterateParallel(struct jaTree* tree, size_t workers_no,
+                          void (*callback)(struct jaTree*, const void* parent_value, void* value, void* extra_data),
+                          size_t value_size, const void* value, void* extra_data)
+{
+	struct Shared shared = {0};
+
+	if (tree == NULL || callback == NULL)
+		return 1;
+
+	shared.callback = callback;
+	shared.extra_data = extra_data;
+	shared.value_size = value_size;
+
+	return sRun(&shared, tree, workers_no, value);
+}
+
+
+/*-----------------------------
+
+ jaTreeDeleteParallel()
+-----------------------------*/
+void jaTreeDeleteParallel(struct jaTree* tree, size_t workers_no)
+{
+	struct Shared shared = {0};
+
+	if (tree == NULL)
+		return;
+
+	jaTreeDetach(tree);
+
+	// Fails only before deleting anything
+	if (workers_no <= 1 || tree->pool != NULL || sRun(&shared, tree, workers_no, NULL) != 0)
+		jaTreeDelete(tree);
+}
@@ -31,6 +31,7 @@ SOFTWARE.
 #include <stdlib.h>
 #include <string.h>
 
+#include "common.h"
 #include "japan-tree.h"
 
 
@@ -88,7 +89,8 @@ struct jaTree* jaTreeIterate(struct jaTreeState* state, struct jaBuffer* buffer)
 		// Next parent
 		else if (state->depth > 0)
 		{
-			future_parent_heap = buffer->data;
+			if (buffer != NULL)
+				future_parent_heap = buffer->data;
 
 			while ((state->future_depth -= 1) > 0)
 			{
@@ -100,7 +102,7 @@ struct jaTree* jaTreeIterate(struct jaTreeState* state, struct jaBuffer* buffer)
 						break;
 					}
 				}
-				else
+				else if (future_parent_heap != NULL)
 				{
 					if (future_parent_heap[state->future_depth] != NULL)
 					{
@@ -116,11 +118,234 @@ struct jaTree* jaTreeIterate(struct jaTreeState* state, struct jaBuffer* buffer)
 }
 
 
-struct jaTree* jaTreeCreate(struct jaTree* parent, void* data, size_t data_size)
+static struct jaTree* sPreOrder(const struct jaTree* start, struct jaTree* node, size_t* depth, size_t max_depth)
+{
+	// Childrens, unless at 'max_depth'
+	if (node->children != NULL && *depth < max_depth)
+	{
+		*depth += 1;
+		return node->children;
+	}
+
+	// Brothers, of it or of the first parent with one
+	for (; node != start; node = node->parent, *depth -= 1)
+	{
+		if (node->next != NULL)
+			return node->next;
+	}
+
+	return NULL;
+}
+
+
+static struct jaTree* sLeftmostLeaf(struct jaTree* node, size_t* depth)
+{
+	for (; node->children != NULL; node = node->children)
+		*depth += 1;
+
+	return node;
+}
+
+
+static struct jaTree* sPostOrder(const struct jaTree* start, struct jaTree* node, size_t* depth)
+{
+	if (node == start)
+		return NULL;
+
+	if (node->next != NULL)
+		return sLeftmostLeaf(node->next, depth);
+
+	*depth -= 1;
+	return node->parent;
+}
+
+
+static struct jaTree* sAtLevel(const struct jaTree* start, struct jaTree* node, size_t* depth, size_t level)
+{
+	// Next one at 'level', walking in pre-order without going deeper
+	while ((node = sPreOrder(start, node, depth, level)) != NULL && *depth != level)
+		;
+
+	return node;
+}
+
+
+struct jaTree* jaTreeIterateNext(struct jaTreeCursor* cursor)
+{
+	if (cursor->actual == NULL)
+	{
+		if (cursor->start == NULL)
+			return NULL;
+
+		cursor->level = 0;
+		cursor->future_depth = 0;
+		cursor->future_return = (cursor->order == JA_TREE_POST_ORDER)
+		                            ? sLeftmostLeaf(cursor->start, &cursor->future_depth)
+		                            : cursor->start;
+	}
+
+	// Actual value (to return)
+	if ((cursor->actual = cursor->future_return) == NULL)
+	{
+		cursor->start = NULL;
+		return NULL;
+	}
+
+	cursor->depth = cursor->future_depth;
+
+	// Future values, only from 'actual' links
+	switch (cursor->order)
+	{
+	case JA_TREE_POST_ORDER:
+		cursor->future_return = sPostOrder(cursor->start, cursor->actual, &cursor->future_depth);
+		break;
+
+	case JA_TREE_BREADTH_FIRST:
+		if ((cursor->future_return = sAtLevel(cursor->start, cursor->actual, &cursor->future_depth, cursor->level)) ==
+		    NULL)
+		{
+			// Next level, from the start
+			cursor->level += 1;
+			cursor->future_depth = 0;
+			cursor->future_return = sAtLevel(cursor->start, cursor->start, &cursor->future_depth, cursor->level);
+		}
+		break;
+
+	default:
+		cursor->future_return = sPreOrder(cursor->start, cursor->actual, &cursor->future_depth, SIZE_MAX);
+	}
+
+	return cursor->actual;
+}
+
+
+#define INITIAL_CHUNK_SIZE (16 * 1024)
+#define MAX_CHUNK_SIZE (4 * 1024 * 1024)
+
+struct jaTreeChunk
+{
+	struct jaTreeChunk* next;
+	size_t size;
+	size_t used;
+};
+
+struct jaTreePool
+{
+	struct jaTree* root;
+	const struct jaAllocator* allocator;
+	enum jaTreePoolFlags flags;
+
+	struct jaTreeChunk* first;
+	struct jaTreeChunk* actual;
+	struct jaTree* spare_nodes; // Linked by 'next', with 'pool' set to NULL
+	size_t chunk_size;
+};
+
+struct PoolSlot
+{
+	size_t capacity; // Of the data after the node
+	struct jaTree node;
+};
+
+
+static struct jaTree* sPoolAlloc(struct jaTreePool* pool, size_t data_size)
+{
+	struct jaTreeChunk* chunk = pool->actual;
+	struct PoolSlot* slot = NULL;
+	size_t size = 0;
+
+	// Deleted nodes first, trees tend to have a single size of them
+	if (pool->spare_nodes != NULL)
+	{
+		slot = (struct PoolSlot*)((uint8_t*)pool->spare_nodes - offsetof(struct PoolSlot, node));
+
+		if (slot->capacity >= data_size)
+		{
+			pool->spare_nodes = slot->node.next;
+			return &slot->node;
+		}
+	}
+
+	// Otherwise the actual chunk, or a new one
+	if (data_size > SIZE_MAX - sizeof(struct PoolSlot) - 8)
+		return NULL;
+
+	size = (sizeof(struct PoolSlot) + data_size + 7) & ~(size_t)7;
+
+	if (chunk == NULL || chunk->size - chunk->used < size)
+	{
+		if (pool->chunk_size == 0)
+			pool->chunk_size = INITIAL_CHUNK_SIZE;
+
+		if ((chunk = Allocate(pool->allocator, sizeof(struct jaTreeChunk) +
+		                                           ((size > pool->chunk_size) ? size : pool->chunk_size))) == NULL)
+			return NULL;
+
+		chunk->next = NULL;
+		chunk->size = (size > pool->chunk_size) ? size : pool->chunk_size;
+		chunk->used = 0;
+
+		if (pool->actual != NULL)
+			pool->actual->next = chunk;
+		else
+			pool->first = chunk;
+
+		pool->actual = chunk;
+
+		if (pool->chunk_size < MAX_CHUNK_SIZE)
+			pool->chunk_size *= 2;
+	}
+
+	slot = (struct PoolSlot*)((uint8_t*)(chunk + 1) + chunk->used);
+	slot->capacity = size - sizeof(struct PoolSlot);
+	chunk->used += size;
+
+	return &slot->node;
+}
+
+
+static void sPoolDelete(struct jaTreePool* pool)
+{
+	struct jaTreeChunk* chunk = pool->first;
+	struct jaTreeChunk* next = NULL;
+	struct PoolSlot* slot = NULL;
+
+	// A pass over the chunks only for callbacks, nodes in creation order
+	if (pool->flags & JA_TREE_POOL_CALLBACKS)
+	{
+		for (; chunk != NULL; chunk = chunk->next)
+		{
+			for (size_t i = 0; i < chunk->used; i += sizeof(struct PoolSlot) + slot->capacity)
+			{
+				slot = (struct PoolSlot*)((uint8_t*)(chunk + 1) + i);
+
+				if (slot->node.pool != NULL && slot->node.callback_delete != NULL)
+					slot->node.callback_delete(&slot->node);
+			}
+		}
+	}
+
+	for (chunk = pool->first; chunk != NULL; chunk = next)
+	{
+		next = chunk->next;
+		Deallocate(pool->allocator, chunk);
+	}
+
+	Deallocate(pool->allocator, pool);
+}
+
+
+static struct jaTree* sCreate(struct jaTree* parent, void* data, size_t data_size,
+                              const struct jaAllocator* allocator, struct jaTreePool* pool)
 {
 	struct jaTree* tree = NULL;
 
-	if ((tree = malloc(sizeof(struct jaTree) + data_size)) != NULL)
+	if (pool != NULL)
+		tree = sPoolAlloc(pool, data_size);
+	else
+		tree = Allocate(allocator, sizeof(struct jaTree) + data_size);
+
+	if (tree != NULL)
 	{
 		if (data_size == 0)
 			tree->data = data;
@@ -133,6 +358,8 @@ struct jaTree* jaTreeCreate(struct jaTree* parent, void* data, size_t data_size)
 		}
 
 		tree->callback_delete = NULL;
+		tree->allocator = allocator;
+		tree->pool = pool;
 		tree->last_children = NULL;
 		tree->children = NULL;
 		tree->parent = NULL;
@@ -146,32 +373,88 @@ struct jaTree* jaTreeCreate(struct jaTree* parent, void* data, size_t data_size)
 }
 
 
+inline struct jaTree* jaTreeCreate(struct jaTree* parent, void* data, size_t data_size)
+{
+	return jaTreeCreateWith(parent, data, data_size, (parent != NULL) ? parent->allocator : NULL);
+}
+
+
+struct jaTree* jaTreeCreateWith(struct jaTree* parent, void* data, size_t data_size,
+                                const struct jaAllocator* allocator)
+{
+	if (parent != NULL && parent->pool != NULL)
+		return sCreate(parent, data, data_size, parent->pool->allocator, parent->pool);
+
+	return sCreate(parent, data, data_size, allocator, NULL);
+}
+
+
+struct jaTree* jaTreeCreatePool(void* data, size_t data_size, const struct jaAllocator* allocator,
+                                enum jaTreePoolFlags flags)
+{
+	struct jaTreePool* pool = NULL;
+
+	if ((pool = Allocate(allocator, sizeof(struct jaTreePool))) == NULL)
+		return NULL;
+
+	pool->allocator = allocator;
+	pool->flags = flags;
+	pool->first = NULL;
+	pool->actual = NULL;
+	pool->spare_nodes = NULL;
+	pool->chunk_size = 0;
+
+	if ((pool->root = sCreate(NULL, data, data_size, allocator, pool)) == NULL)
+	{
+		Deallocate(allocator, pool);
+		return NULL;
+	}
+
+	return pool->root;
+}
+
+
 void jaTreeDelete(struct jaTree* tree)
 {
-	struct jaTreeState state;
-	struct jaBuffer buffer = {0};
+	// Childrens before their parents, without a stack at any depth
+	struct jaTreeCursor cursor = {0};
 
-	if (tree != NULL)
+	if (tree == NULL)
+		return;
+
+	// A root of a pool takes all its nodes with it
+	if (tree->pool != NULL && tree->pool->root == tree)
 	{
-		state.start = tree;
-		jaTreeDetach(tree);
+		sPoolDelete(tree->pool);
+		return;
+	}
 
-		while ((tree = jaTreeIterate(&state, &buffer)) != NULL)
-		{
-			if (tree->callback_delete != NULL)
-				tree->callback_delete(tree);
+	cursor.start = tree;
+	cursor.order = JA_TREE_POST_ORDER;
+	jaTreeDetach(tree);
 
-			free(tree);
-		}
+	while ((tree = jaTreeIterateNext(&cursor)) != NULL)
+	{
+		if (tree->callback_delete != NULL)
+			tree->callback_delete(tree);
 
-		jaBufferClean(&buffer);
+		if (tree->pool != NULL)
+		{
+			tree->next = tree->pool->spare_nodes;
+			tree->pool->spare_nodes = tree;
+			tree->pool = NULL;
+		}
+		else
+			Deallocate(tree->allocator, tree);
 	}
 }
 
 
 inline int jaTreeAttach(struct jaTree* tree, struct jaTree* new_parent)
 {
-	if (tree->parent == NULL && new_parent != NULL)
+	// Nodes of pools stay in them, and their roots at the top
+	if (tree->parent == NULL && new_parent != NULL && tree->pool == new_parent->pool &&
+	    (tree->pool == NULL || tree->pool->root != tree))
 	{
 		tree->parent = new_parent;
 
@@ -240,3 +523,276 @@ inline int jaTreeDetach(struct jaTree* tree)
 
 	return 1;
 }
+
+
+
+static inline struct jaFlatTreeNode* sFlatNode(const struct jaFlatTree* tree, uint32_t index)
+{
+	return (struct jaFlatTreeNode*)tree->nodes.data + index;
+}
+
+
+static inline bool sFlatValid(const struct jaFlatTree* tree, uint32_t index)
+{
+	return (index < tree->nodes_no && sFlatNode(tree, index)->parent != JA_FLAT_TREE_REMOVED) ? true : false;
+}
+
+
+static inline uint32_t* sFlatFirst(struct jaFlatTree* tree, uint32_t parent)
+{
+	return (parent != JA_FLAT_TREE_NONE) ? &sFlatNode(tree, parent)->children : &tree->first;
+}
+
+
+static inline uint32_t* sFlatLast(struct jaFlatTree* tree, uint32_t parent)
+{
+	return (parent != JA_FLAT_TREE_NONE) ? &sFlatNode(tree, parent)->last_children : &tree->last;
+}
+
+
+static bool sAppendsInOrder(const struct jaFlatTree* tree, uint32_t parent)
+{
+	// Only if the parent is in the last branch, where the array ends
+	if (parent == JA_FLAT_TREE_NONE)
+		return true;
+
+	for (uint32_t i = (uint32_t)(tree->nodes_no - 1); i != JA_FLAT_TREE_NONE; i = sFlatNode(tree, i)->parent)
+	{
+		if (i == parent)
+			return true;
+	}
+
+	return false;
+}
+
+
+uint32_t jaFlatTreeAdd(struct jaFlatTree* tree, uint32_t parent, const void* data)
+{
+	struct jaFlatTreeNode* node = NULL;
+	uint32_t index = (uint32_t)tree->nodes_no;
+	uint32_t* last = NULL;
+
+	if (tree->nodes_no == 0)
+	{
+		tree->first = JA_FLAT_TREE_NONE;
+		tree->last = JA_FLAT_TREE_NONE;
+		tree->ordered = true;
+	}
+
+	if (tree->nodes_no >= JA_FLAT_TREE_REMOVED || (parent != JA_FLAT_TREE_NONE && sFlatValid(tree, parent) == false))
+		return JA_FLAT_TREE_NONE;
+
+	if (jaBufferAppend(&tree->nodes, NULL, sizeof(struct jaFlatTreeNode)) == NULL)
+		return JA_FLAT_TREE_NONE;
+
+	if (tree->data_size != 0 && jaBufferAppend(&tree->data, NULL, tree->data_size) == NULL)
+	{
+		tree->nodes.length -= sizeof(struct jaFlatTreeNode);
+		return JA_FLAT_TREE_NONE;
+	}
+
+	if (tree->data_size != 0 && data != NULL)
+		memcpy((uint8_t*)tree->data.data + tree->data_size * index, data, tree->data_size);
+
+	if (tree->ordered == true)
+		tree->ordered = sAppendsInOrder(tree, parent);
+
+	node = sFlatNode(tree, index);
+	node->parent = parent;
+	node->next = JA_FLAT_TREE_NONE;
+	node->children = JA_FLAT_TREE_NONE;
+	node->last_children = JA_FLAT_TREE_NONE;
+
+	// Last children, or last root
+	if (*(last = sFlatLast(tree, parent)) != JA_FLAT_TREE_NONE)
+		sFlatNode(tree, *last)->next = index;
+	else
+		*sFlatFirst(tree, parent) = index;
+
+	*last = index;
+	tree->nodes_no += 1;
+
+	return index;
+}
+
+
+int jaFlatTreeRemove(struct jaFlatTree* tree, uint32_t index)
+{
+	struct jaFlatTreeNode* node = NULL;
+	uint32_t previous = JA_FLAT_TREE_NONE;
+	uint32_t parent = 0;
+	uint32_t next = 0;
+	uint32_t i = 0;
+	bool done = false;
+
+	if (sFlatValid(tree, index) == false)
+		return 1;
+
+	// Unlink it, brothers only link forward
+	parent = sFlatNode(tree, index)->parent;
+
+	for (i = *sFlatFirst(tree, parent); i != index; i = sFlatNode(tree, i)->next)
+		previous = i;
+
+	if (previous != JA_FLAT_TREE_NONE)
+		sFlatNode(tree, previous)->next = sFlatNode(tree, index)->next;
+	else
+		*sFlatFirst(tree, parent) = sFlatNode(tree, index)->next;
+
+	if (*sFlatLast(tree, parent) == index)
+		*sFlatLast(tree, parent) = previous;
+
+	// Mark it and its children, each one once done with its own
+	for (i = index; done == false;)
+	{
+		while (sFlatNode(tree, i)->children != JA_FLAT_TREE_NONE)
+			i = sFlatNode(tree, i)->children;
+
+		for (;;)
+		{
+			node = sFlatNode(tree, i);
+			next = node->next;
+			parent = node->parent;
+			node->parent = JA_FLAT_TREE_REMOVED;
+
+			if (i == index)
+			{
+				done = true;
+				break;
+			}
+
+			if (next != JA_FLAT_TREE_NONE)
+			{
+				i = next;
+				break;
+			}
+
+			i = parent;
+		}
+	}
+
+	tree->ordered = false;
+	return 0;
+}
+
+
+static inline uint32_t sRemap(const uint32_t* new_index, uint32_t index)
+{
+	return (index != JA_FLAT_TREE_NONE) ? new_index[index] : JA_FLAT_TREE_NONE;
+}
+
+
+int jaFlatTreeCompact(struct jaFlatTree* tree)
+{
+	struct jaBuffer nodes = tree->nodes;
+	struct jaBuffer data = tree->data;
+	struct jaFlatTreeNode* node = NULL;
+	uint32_t* new_index = NULL;
+	uint32_t n = 0;
+
+	if (tree->ordered == true || tree->nodes_no == 0)
+		return 0;
+
+	// Same settings, only what is required
+	nodes.data = NULL;
+	nodes.size = 0;
+	nodes.length = 0;
+	data.data = NULL;
+	data.size = 0;
+	data.length = 0;
+
+	if ((new_index = Allocate(tree->nodes.allocator, sizeof(uint32_t) * tree->nodes_no)) == NULL)
+		return 1;
+
+	for (uint32_t i = jaFlatTreeNext(tree, JA_FLAT_TREE_NONE); i != JA_FLAT_TREE_NONE; i = jaFlatTreeNext(tree, i))
+		new_index[i] = n++;
+
+	if (jaBufferReserve(&nodes, (n != 0) ? sizeof(struct jaFlatTreeNode) * n : 1) == NULL ||
+	    (tree->data_size != 0 && jaBufferReserve(&data, tree->data_size * ((n != 0) ? n : 1)) == NULL))
+	{
+		Deallocate(tree->nodes.allocator, new_index);
+		jaBufferClean(&nodes);
+		return 1;
+	}
+
+	nodes.length = sizeof(struct jaFlatTreeNode) * n;
+	data.length = tree->data_size * n;
+
+	for (uint32_t i = jaFlatTreeNext(tree, JA_FLAT_TREE_NONE); i != JA_FLAT_TREE_NONE; i = jaFlatTreeNext(tree, i))
+	{
+		node = (struct jaFlatTreeNode*)nodes.data + new_index[i];
+		node->parent = sRemap(new_index, sFlatNode(tree, i)->parent);
+		node->next = sRemap(new_index, sFlatNode(tree, i)->next);
+		node->children = sRemap(new_index, sFlatNode(tree, i)->children);
+		node->last_children = sRemap(new_index, sFlatNode(tree, i)->last_children);
+
+		if (tree->data_size != 0)
+			memcpy((uint8_t*)data.data + tree->data_size * new_index[i], jaFlatTreeData(tree, i), tree->data_size);
+	}
+
+	tree->first = (n != 0) ? 0 : JA_FLAT_TREE_NONE;
+	tree->last = sRemap(new_index, tree->last);
+
+	Deallocate(tree->nodes.allocator, new_index);
+	jaBufferClean(&tree->nodes);
+	jaBufferClean(&tree->data);
+
+	tree->nodes = nodes;
+	tree->data = data;
+	tree->nodes_no = n;
+	tree->ordered = true;
+
+	return 0;
+}
+
+
+void jaFlatTreeClean(struct jaFlatTree* tree)
+{
+	jaBufferClean(&tree->nodes);
+	jaBufferClean(&tree->data);
+
+	tree->nodes_no = 0;
+	tree->first = JA_FLAT_TREE_NONE;
+	tree->last = JA_FLAT_TREE_NONE;
+	tree->ordered = true;
+}
+
+
+inline struct jaFlatTreeNode* jaFlatTreeNode(const struct jaFlatTree* tree, uint32_t index)
+{
+	return (index < tree->nodes_no) ? sFlatNode(tree, index) : NULL;
+}
+
+
+inline void* jaFlatTreeData(const struct jaFlatTree* tree, uint32_t index)
+{
+	if (index >= tree->nodes_no || tree->data_size == 0)
+		return NULL;
+
+	return (uint8_t*)tree->data.data + tree->data_size * index;
+}
+
+
+uint32_t jaFlatTreeNext(const struct jaFlatTree* tree, uint32_t index)
+{
+	if (tree->nodes_no == 0)
+		return JA_FLAT_TREE_NONE;
+
+	if (index == JA_FLAT_TREE_NONE)
+		return tree->first;
+
+	if (tree->ordered == true)
+		return (index + 1 < tree->nodes_no) ? index + 1 : JA_FLAT_TREE_NONE;
+
+	// Children, otherwise the next brother of it or of a parent
+	if (sFlatNode(tree, index)->children != JA_FLAT_TREE_NONE)
+		return sFlatNode(tree, index)->children;
+
+	for (; index != JA_FLAT_TREE_NONE; index = sFlatNode(tree, index)->parent)
+	{
+		if (sFlatNode(tree, index)->next != JA_FLAT_TREE_NONE)
+			return sFlatNode(tree, index)->next;
+	}
+
+	return JA_FLAT_TREE_NONE;
+}
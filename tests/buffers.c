@@ -0,0 +1,220 @@
+/*-----------------------------
+
+ [buffers.c]
+ - Alexander Brandt 2020
+-----------------------------*/
+
+#include <math.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <cmocka.h>
+
+#include "japan-buffer.h"
+#include "japan-image.h"
+#include "japan-list.h"
+#include "japan-sound.h"
+#include "japan-tree.h"
+
+
+void BufferTest1_Append(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	struct jaBuffer buffer = {0};
+	size_t last_size = 0;
+	size_t reallocations = 0;
+
+	// A byte at a time, reallocations only when the capacity runs out
+	for (size_t i = 0; i < 1000000; i++)
+	{
+		assert_int_equal(jaBufferAppendByte(&buffer, (uint8_t)i), 0);
+
+		if (buffer.size != last_size)
+		{
+			reallocations += 1;
+			last_size = buffer.size;
+		}
+	}
+
+	assert_int_equal(buffer.length, 1000000);
+	assert_true((buffer.size >= buffer.length && reallocations < 24));
+
+	for (size_t i = 0; i < 1000000; i++)
+		assert_int_equal(((uint8_t*)buffer.data)[i], (uint8_t)i);
+
+	// Clear keeps the capacity, shrink doesn't
+	jaBufferClear(&buffer);
+	assert_true((buffer.length == 0 && buffer.size == last_size));
+
+	assert_true((jaBufferAppend(&buffer, "Hello", 5) == buffer.data));
+	assert_true((memcmp(jaBufferAppend(&buffer, NULL, 7), (char*)buffer.data + 5, 7) == 0));
+	assert_int_equal(buffer.length, 12);
+
+	assert_int_equal(jaBufferShrinkToFit(&buffer), 0);
+	assert_true((buffer.size == 12 && memcmp(buffer.data, "Hello", 5) == 0));
+
+	// Reserve is exact, a slower growth factor
+	jaBufferClean(&buffer);
+	buffer.growth = 150;
+
+	assert_true((jaBufferReserve(&buffer, 100) != NULL && buffer.size == 100 && buffer.length == 0));
+	assert_true((jaBufferReserve(&buffer, 10) != NULL && buffer.size == 100)); // Never shrinks
+
+	assert_true((jaBufferAppend(&buffer, NULL, 101) != NULL));
+	assert_int_equal(buffer.size, 151);
+
+	jaBufferClear(&buffer);
+	assert_int_equal(jaBufferShrinkToFit(&buffer), 0);
+	assert_true((buffer.data == NULL && buffer.size == 0));
+}
+
+
+void BufferTest2_Aligned(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	enum jaBufferFlags flags[] = {JA_BUFFER_ALIGN_32, JA_BUFFER_ALIGN_64, JA_BUFFER_HUGE_PAGES,
+	                              JA_BUFFER_HUGE_PAGES | JA_BUFFER_ALIGN_64};
+
+	for (size_t f = 0; f < (sizeof(flags) / sizeof(enum jaBufferFlags)); f++)
+	{
+		struct jaBuffer buffer = {0};
+		size_t alignment = (flags[f] & JA_BUFFER_ALIGN_64) ? 64 : (flags[f] & JA_BUFFER_ALIGN_32) ? 32 : 1;
+
+		buffer.flags = flags[f];
+
+		// Growing from the heap to mapped pages (if huge ones), content preserved
+		for (size_t i = 0; i < 3 * 1024 * 1024; i += 4096)
+		{
+			uint8_t* page = jaBufferAppend(&buffer, NULL, 4096);
+
+			assert_true((page != NULL && ((uintptr_t)buffer.data % alignment) == 0));
+			memset(page, (int)((i / 4096) % 251), 4096);
+		}
+
+		for (size_t i = 0; i < 3 * 1024 * 1024; i += 4096)
+			assert_int_equal(((uint8_t*)buffer.data)[i + 4095], (i / 4096) % 251);
+
+		assert_true((jaBufferReserve(&buffer, 9 * 1024 * 1024) != NULL && buffer.size >= 9 * 1024 * 1024));
+		assert_int_equal(((uint8_t*)buffer.data)[3 * 1024 * 1024 - 1], ((3 * 1024 * 1024 - 1) / 4096) % 251);
+
+		// And back
+		buffer.length = 100;
+		assert_int_equal(jaBufferShrinkToFit(&buffer), 0);
+		assert_true(((uintptr_t)buffer.data % alignment) == 0);
+		assert_int_equal(((uint8_t*)buffer.data)[99], 0);
+
+		jaBufferClean(&buffer);
+	}
+
+	// Images and sounds requesting it
+	struct jaImage* image = jaImageCreateEx(JA_IMAGE_FLOAT, 1920, 1080, 4, JA_BUFFER_ALIGN_64 | JA_BUFFER_HUGE_PAGES);
+	struct jaSound* sound = jaSoundCreateEx(JA_SOUND_F32, 48000, 2, 48000, JA_BUFFER_ALIGN_32);
+
+	assert_true((image != NULL && ((uintptr_t)image->data % 64) == 0 && image->size == 1920 * 1080 * 16));
+	assert_true((sound != NULL && ((uintptr_t)sound->data % 32) == 0 && sound->size == 48000 * 2 * 4));
+
+	memset(image->data, 0xFF, image->size);
+	memset(sound->data, 0xFF, sound->size);
+
+	jaImageDelete(image);
+	jaSoundDelete(sound);
+}
+
+
+struct Counter
+{
+	size_t live;
+	size_t calls;
+};
+
+static void* sCountAllocate(size_t size, void* context)
+{
+	((struct Counter*)context)->live += 1;
+	((struct Counter*)context)->calls += 1;
+	return malloc(size);
+}
+
+static void* sCountReallocate(void* ptr, size_t size, void* context)
+{
+	((struct Counter*)context)->live += (ptr == NULL) ? 1 : 0;
+	((struct Counter*)context)->calls += 1;
+	return realloc(ptr, size);
+}
+
+static void sCountDeallocate(void* ptr, void* context)
+{
+	((struct Counter*)context)->live -= 1;
+	free(ptr);
+}
+
+void BufferTest3_Allocator(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	struct Counter counter = {0};
+	struct jaAllocator allocator = {sCountAllocate, sCountReallocate, sCountDeallocate, &counter};
+	enum jaBufferFlags flags[] = {JA_BUFFER_DEFAULT, JA_BUFFER_ALIGN_32, JA_BUFFER_ALIGN_64};
+
+	// Buffers, aligned ones over allocated
+	for (size_t f = 0; f < (sizeof(flags) / sizeof(enum jaBufferFlags)); f++)
+	{
+		struct jaBuffer buffer = {0};
+		size_t alignment = (flags[f] & JA_BUFFER_ALIGN_64) ? 64 : (flags[f] & JA_BUFFER_ALIGN_32) ? 32 : 1;
+
+		buffer.flags = flags[f];
+		buffer.allocator = &allocator;
+
+		for (size_t i = 0; i < 100000; i++)
+			assert_int_equal(jaBufferAppendByte(&buffer, (uint8_t)i), 0);
+
+		assert_true(((uintptr_t)buffer.data % alignment) == 0);
+		assert_int_equal(((uint8_t*)buffer.data)[99999], (uint8_t)99999);
+
+		buffer.length = 10;
+		assert_int_equal(jaBufferShrinkToFit(&buffer), 0);
+		assert_int_equal(((uint8_t*)buffer.data)[9], 9);
+
+		jaBufferClean(&buffer);
+		assert_int_equal(counter.live, 0);
+	}
+
+	// Images and sounds
+	struct jaImage* image = jaImageCreateWith(JA_IMAGE_U8, 64, 64, 3, JA_BUFFER_DEFAULT, &allocator);
+	struct jaSound* sound = jaSoundCreateWith(JA_SOUND_I16, 4800, 2, 48000, JA_BUFFER_ALIGN_64, &allocator);
+
+	assert_true((image != NULL && image->allocator == &allocator));
+	assert_true((sound != NULL && ((uintptr_t)sound->data % 64) == 0));
+	assert_int_equal(counter.live, 3);
+
+	jaImageDelete(image);
+	jaSoundDelete(sound);
+	assert_int_equal(counter.live, 0);
+
+	// Lists and trees, children take the allocator of their parent
+	struct jaList list = {0};
+	list.allocator = &allocator;
+
+	for (int i = 0; i < 100; i++)
+		assert_true((jaListAdd(&list, &i, sizeof(int)) != NULL));
+
+	jaListClean(&list);
+
+	struct jaTree* root = jaTreeCreateWith(NULL, NULL, 0, &allocator);
+	struct jaTree* branch = root;
+
+	for (int i = 0; i < 100; i++)
+		assert_true(((branch = jaTreeCreate(branch, &i, sizeof(int))) != NULL && branch->allocator == &allocator));
+
+	jaTreeDelete(root);
+
+	assert_int_equal(counter.live, 0);
+	assert_true((counter.calls != 0));
+}
@@ -122,6 +122,19 @@ void ConfigTest1(void** cmocka_state)
 	jaCvarGetValueString(jaCvarGet(cfg, "name"), &value.s, NULL);
 	assert_true((strcmp(value.s, "OwO") == 0));
 
+	// Same, trough views
+	struct jaBufferView view;
+	const char* line = "render.height=240 name=OwO";
+
+	assert_true((jaCvarGetView(cfg, jaBufferViewOf(line, 13)) == a));
+	assert_true((jaCvarGetView(cfg, jaBufferViewOf(line + 18, 4)) == b));
+	assert_true((jaCvarGetView(cfg, jaBufferViewOf(line, 6)) == NULL));
+
+	assert_true((jaCvarGetValueView(b, &view, NULL) == 0));
+	assert_true((jaBufferViewEqual(view, jaBufferViewOf(line + 23, 3)) == 1));
+	assert_true((view.data == value.s)); // Not a copy
+	assert_true((jaCvarGetValueView(a, &view, NULL) != 0));
+
 	// Delete some
 	jaCvarDelete(a);
 	jaCvarDelete(b);
@@ -89,13 +89,11 @@ static void IterationCallback(struct jaDictionaryItem* item, void* user_data)
 	}
 }
 
-extern void DictionaryTest2_SimpleUsage(void** cmocka_state)
+static void sSimpleUsage(enum jaDictionaryFlags flags)
 {
-	(void)cmocka_state;
-
 	// Create a dictionary, we need a large
 	// one so the rehashing mechanism get used
-	struct jaDictionary* d = jaDictionaryCreate(NULL);
+	struct jaDictionary* d = jaDictionaryCreateEx(NULL, flags);
 
 	struct jaDictionaryItem* secuencia = jaDictionaryAdd(d, "Secuencia", "Secuencia Inicial", 0);
 	struct jaDictionaryItem* ruta = jaDictionaryAdd(d, "Ruta", "Toma La Ruta", 0);
@@ -155,6 +153,13 @@ extern void DictionaryTest2_SimpleUsage(void** cmocka_state)
 
 	assert_false(e);
 
+	// Hashes are stored at addition
+	if ((flags & JA_DICTIONARY_WYHASH) != 0)
+		assert_true((moire->hash == jaWyHash("Moire", strlen("Moire"))));
+	else
+		assert_true((moire->hash == jaFNV1Hash("Moire", strlen("Moire"))));
+	assert_int_equal(moire->key_size, strlen("Moire"));
+
 	// Remove some items in a random order
 	JA_DEBUG_PRINT("\n####\n\n");
 
@@ -184,3 +189,764 @@ extern void DictionaryTest2_SimpleUsage(void** cmocka_state)
 	// Bye!
 	jaDictionaryDelete(d);
 }
+
+
+extern void DictionaryTest2_SimpleUsage(void** cmocka_state)
+{
+	(void)cmocka_state;
+	sSimpleUsage(JA_DICTIONARY_DEFAULT);
+}
+
+
+/*-----------------------------
+
+ DictionaryTest3_OpenAddressing()
+-----------------------------*/
+extern void DictionaryTest3_OpenAddressing(void** cmocka_state)
+{
+	(void)cmocka_state;
+	sSimpleUsage(JA_DICTIONARY_OPEN_ADDRESSING);
+}
+
+
+/*-----------------------------
+
+ DictionaryTest4_LengthAware()
+-----------------------------*/
+extern void DictionaryTest4_LengthAware(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	enum jaDictionaryFlags flags[] = {JA_DICTIONARY_DEFAULT, JA_DICTIONARY_OPEN_ADDRESSING};
+	const char* text = "render.width render.height sound.volume";
+
+	for (size_t i = 0; i < (sizeof(flags) / sizeof(enum jaDictionaryFlags)); i++)
+	{
+		struct jaDictionary* d = jaDictionaryCreateEx(NULL, flags[i]);
+
+		// Keys as slices of a bigger buffer, without a NULL terminator
+		struct jaDictionaryItem* width = jaDictionaryAddN(d, text, 12, "640", 0);
+		struct jaDictionaryItem* height = jaDictionaryAddN(d, text + 13, 13, "480", 0);
+
+		assert_string_equal(width->key, "render.width"); // Stored ones are terminated
+		assert_int_equal(height->key_size, 13);
+
+		assert_true(jaDictionaryGetN(d, text, 12) == width);
+		assert_true(jaDictionaryGet(d, "render.height") == height);
+		assert_true(jaDictionaryGetN(d, text, 6) == NULL); // Prefix 'render'
+		assert_true(jaDictionaryGetN(d, text + 27, 12) == NULL);
+
+		// Binary keys, NULL is just another byte
+		struct jaDictionaryItem* a = jaDictionaryAddN(d, "key\0a", 5, "A", 0);
+		struct jaDictionaryItem* b = jaDictionaryAddN(d, "key\0b", 5, "B", 0);
+
+		assert_true(jaDictionaryGetN(d, "key\0a", 5) == a);
+		assert_true(jaDictionaryGetN(d, "key\0b", 5) == b);
+		assert_true(jaDictionaryGet(d, "key") == NULL);
+
+		// Removal
+		assert_int_equal(jaDictionaryRemoveN(d, "key\0a", 5), 0);
+		assert_int_equal(jaDictionaryRemoveN(d, "key\0a", 5), 1);
+		assert_true(jaDictionaryGetN(d, "key\0b", 5) == b);
+
+		jaDictionaryDelete(d);
+	}
+}
+
+
+/*-----------------------------
+
+ DictionaryTest5_WyHash()
+-----------------------------*/
+extern void DictionaryTest5_WyHash(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	// Every prefix of a buffer, crossing all the tail and block paths
+	const char* text = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt "
+	                   "ut labore et dolore magna aliqua";
+	uint64_t hashes[100];
+
+	for (size_t i = 0; i < 100; i++)
+	{
+		hashes[i] = jaWyHash(text, i);
+		assert_true((hashes[i] == jaWyHash(text, i)));
+
+		for (size_t u = 0; u < i; u++)
+			assert_true((hashes[i] != hashes[u]));
+	}
+
+	// Misaligned keys
+	char buffer[72];
+	memcpy(buffer + 1, text, 71);
+	assert_true((jaWyHash(buffer + 1, 71) == hashes[71]));
+
+	// As a dictionary hash
+	sSimpleUsage(JA_DICTIONARY_WYHASH);
+	sSimpleUsage(JA_DICTIONARY_WYHASH | JA_DICTIONARY_OPEN_ADDRESSING);
+}
+
+
+/*-----------------------------
+
+ DictionaryTest6_Arena()
+-----------------------------*/
+static size_t s_deleted_no = 0;
+
+static void sCountDeleted(struct jaDictionaryItem* item)
+{
+	(void)item;
+	s_deleted_no++;
+}
+
+extern void DictionaryTest6_Arena(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	enum jaDictionaryFlags flags[] = {JA_DICTIONARY_ARENA, JA_DICTIONARY_ARENA | JA_DICTIONARY_OPEN_ADDRESSING};
+	char key[32];
+
+	for (size_t f = 0; f < (sizeof(flags) / sizeof(enum jaDictionaryFlags)); f++)
+	{
+		sSimpleUsage(flags[f]);
+
+		struct jaDictionary* d = jaDictionaryCreateEx(NULL, flags[f]);
+		assert_true((d != NULL));
+
+		// Enough items to span several chunks, and collisions to need overflow buckets
+		for (size_t i = 0; i < 5000; i++)
+		{
+			snprintf(key, 32, "item%zu", i);
+			assert_true((jaDictionaryAdd(d, key, &i, sizeof(size_t)) != NULL));
+		}
+
+		// An item bigger than any chunk
+		struct jaDictionaryItem* big = jaDictionaryAdd(d, "big", NULL, 4 * 1024 * 1024);
+		assert_true((big != NULL));
+		memset(big->data, 0xAA, 4 * 1024 * 1024);
+
+		// Shrink, then grown again (recycling buckets)
+		for (size_t i = 0; i < 5000; i += 2)
+		{
+			snprintf(key, 32, "item%zu", i);
+			assert_int_equal(jaDictionaryRemoveN(d, key, strlen(key)), 0);
+		}
+
+		for (size_t i = 5000; i < 7500; i++)
+		{
+			snprintf(key, 32, "item%zu", i);
+			assert_true((jaDictionaryAdd(d, key, &i, sizeof(size_t)) != NULL));
+		}
+
+		for (size_t i = 0; i < 7500; i++)
+		{
+			struct jaDictionaryItem* item = NULL;
+			snprintf(key, 32, "item%zu", i);
+
+			if (i < 5000 && (i % 2) == 0)
+				assert_true((jaDictionaryGet(d, key) == NULL));
+			else
+			{
+				size_t value = 0;
+
+				assert_true(((item = jaDictionaryGet(d, key)) != NULL));
+				memcpy(&value, item->data, sizeof(size_t)); // Inline data isn't aligned
+				assert_int_equal(value, i);
+				item->callback_delete = sCountDeleted;
+			}
+		}
+
+		assert_true((jaDictionaryGet(d, "big") == big));
+
+		// Callbacks still called at deletion, detached items excluded
+		jaDictionaryDetach(big);
+
+		s_deleted_no = 0;
+		jaDictionaryDelete(d);
+		assert_int_equal(s_deleted_no, 5000);
+	}
+}
+
+
+/*-----------------------------
+
+ DictionaryTest7_Reserve()
+-----------------------------*/
+extern void DictionaryTest7_Reserve(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	enum jaDictionaryFlags flags[] = {JA_DICTIONARY_DEFAULT, JA_DICTIONARY_OPEN_ADDRESSING, JA_DICTIONARY_ARENA};
+
+	char* keys_buffer = malloc(sizeof(char) * 16 * 10000);
+	const char** keys = malloc(sizeof(char*) * 10000);
+	void** data = malloc(sizeof(void*) * 10000);
+
+	assert_true((keys_buffer != NULL && keys != NULL && data != NULL));
+
+	for (size_t i = 0; i < 10000; i++)
+	{
+		snprintf(keys_buffer + i * 16, 16, "key%zu", i);
+		keys[i] = keys_buffer + i * 16;
+		data[i] = keys_buffer + i * 16;
+	}
+
+	for (size_t f = 0; f < (sizeof(flags) / sizeof(enum jaDictionaryFlags)); f++)
+	{
+		struct jaDictionary* d = jaDictionaryCreateEx(NULL, flags[f]);
+
+		// Reserve with some items already in, they should be rehashed
+		assert_int_equal(jaDictionaryAddBatch(d, 100, keys, data, 0), 0);
+		assert_int_equal(jaDictionaryReserve(d, 5000), 0);
+		assert_int_equal(jaDictionaryReserve(d, 10), 0); // Never shrinks
+
+		for (size_t i = 0; i < 100; i++)
+			assert_true((jaDictionaryGet(d, keys[i])->data == data[i]));
+
+		// Bigger than reserved
+		assert_int_equal(jaDictionaryAddBatch(d, 10000 - 100, keys + 100, data + 100, 0), 0);
+
+		for (size_t i = 0; i < 10000; i++)
+			assert_true((jaDictionaryGet(d, keys[i])->data == data[i]));
+
+		assert_true((jaDictionaryGet(d, "key10000") == NULL));
+
+		// Everything removed, the table shrinks back
+		for (size_t i = 0; i < 10000; i++)
+			assert_int_equal(jaDictionaryRemoveN(d, keys[i], strlen(keys[i])), 0);
+
+		assert_int_equal(jaDictionaryAddBatch(d, 1, keys, NULL, 0), 0);
+		assert_true((jaDictionaryGet(d, keys[0])->data == NULL));
+
+		jaDictionaryDelete(d);
+	}
+
+	free(keys_buffer);
+	free(keys);
+	free(data);
+}
+
+
+/*-----------------------------
+
+ DictionaryTest8_Concurrent()
+-----------------------------*/
+extern void DictionaryTest8_Concurrent(void** cmocka_state)
+{
+	(void)cmocka_state;
+	char key[32];
+
+	sSimpleUsage(JA_DICTIONARY_CONCURRENT);
+	sSimpleUsage(JA_DICTIONARY_CONCURRENT | JA_DICTIONARY_ARENA);
+
+	struct jaDictionary* d = jaDictionaryCreateEx(NULL, JA_DICTIONARY_CONCURRENT);
+	struct jaDictionaryItem* item = jaDictionaryAdd(d, "Item", "Data", 0);
+	item->callback_delete = sCountDeleted;
+
+	// Removed items live until readers finish
+	size_t token = jaDictionaryReadBegin(d);
+	s_deleted_no = 0;
+
+	assert_true((jaDictionaryGet(d, "Item") == item));
+	jaDictionaryRemove(item);
+
+	assert_true((jaDictionaryGet(d, "Item") == NULL));
+	assert_string_equal(item->data, "Data");
+	assert_int_equal(s_deleted_no, 0);
+
+	jaDictionaryReadEnd(d, token);
+
+	// Eventually reclaimed, here to make space for more retired items
+	for (size_t i = 0; i < 1000; i++)
+	{
+		snprintf(key, 32, "item%zu", i);
+		jaDictionaryAdd(d, key, NULL, 0);
+	}
+
+	for (size_t i = 0; i < 1000; i++)
+	{
+		snprintf(key, 32, "item%zu", i);
+		assert_int_equal(jaDictionaryRemoveN(d, key, strlen(key)), 0);
+	}
+
+	assert_int_equal(s_deleted_no, 1);
+
+	// Detach waits for readers, here none
+	item = jaDictionaryAdd(d, "Item", "Data", 0);
+	assert_int_equal(jaDictionaryDetach(item), 0);
+	assert_int_equal(jaDictionaryDetach(item), 1);
+	free(item);
+
+	jaDictionaryDelete(d);
+}
+
+
+/*-----------------------------
+
+ DictionaryTest9_Sharded()
+-----------------------------*/
+static void sMarkVisited(struct jaDictionaryItem* item, void* extra_data)
+{
+	(void)extra_data;
+	*(bool*)item->data = true; // Every item has its own flag, no race here
+}
+
+extern void DictionaryTest9_Sharded(void** cmocka_state)
+{
+	(void)cmocka_state;
+	char key[32];
+
+	sSimpleUsage(JA_DICTIONARY_SHARDED);
+	sSimpleUsage(JA_DICTIONARY_SHARDED | JA_DICTIONARY_OPEN_ADDRESSING);
+	sSimpleUsage(JA_DICTIONARY_SHARDED | JA_DICTIONARY_ARENA);
+
+	assert_true((jaDictionaryCreateEx(NULL, JA_DICTIONARY_SHARDED | JA_DICTIONARY_CONCURRENT) == NULL));
+
+	bool* visited = calloc(5000, sizeof(bool));
+	assert_true((visited != NULL));
+
+	struct jaDictionary* d = jaDictionaryCreateSharded(NULL, JA_DICTIONARY_SHARDED, 6); // Rounded to 8
+	assert_int_equal(jaDictionaryReserve(d, 2500), 0);
+
+	for (size_t i = 0; i < 5000; i++)
+	{
+		snprintf(key, 32, "shard%zu", i);
+		jaDictionaryAdd(d, key, &visited[i], 0)->callback_delete = sCountDeleted;
+	}
+
+	// Items belong to their shards, but remain reachable from the dictionary
+	struct jaDictionaryItem* item = jaDictionaryGet(d, "shard1234");
+	assert_true((item != NULL && item->dictionary != d));
+
+	assert_int_equal(jaDictionaryDetach(item), 0);
+	assert_true((jaDictionaryGet(d, "shard1234") == NULL));
+	free(item);
+
+	assert_int_equal(jaDictionaryRemoveN(d, "shard0", strlen("shard0")), 0);
+
+	// Every item visited once, by any of the workers
+	jaDictionaryIterateParallel(d, 4, sMarkVisited, NULL);
+
+	for (size_t i = 0; i < 5000; i++)
+		assert_true((visited[i] == (i != 1234 && i != 0)));
+
+	s_deleted_no = 0;
+	jaDictionaryDelete(d);
+	assert_int_equal(s_deleted_no, 5000 - 2); // Minus the detached and removed ones
+
+	free(visited);
+}
+
+
+/*-----------------------------
+
+ DictionaryTest10_Cursor()
+-----------------------------*/
+extern void DictionaryTest10_Cursor(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	enum jaDictionaryFlags flags[] = {JA_DICTIONARY_DEFAULT, JA_DICTIONARY_OPEN_ADDRESSING, JA_DICTIONARY_SHARDED,
+	                                  JA_DICTIONARY_CONCURRENT};
+
+	struct jaDictionaryItem* batch[7];
+	struct jaDictionaryItem* item = NULL;
+	struct jaDictionaryState state = {0};
+	size_t* visits = calloc(5000, sizeof(size_t));
+	char key[32];
+
+	assert_true((visits != NULL));
+
+	for (size_t f = 0; f < (sizeof(flags) / sizeof(enum jaDictionaryFlags)); f++)
+	{
+		struct jaDictionary* d = jaDictionaryCreateEx(NULL, flags[f]);
+
+		// Empty
+		state.start = d;
+		assert_true((jaDictionaryIterateNext(&state) == NULL));
+		assert_true((jaDictionaryIterateNext(&state) == NULL));
+
+		for (size_t i = 0; i < 5000; i++)
+		{
+			snprintf(key, 32, "cursor%zu", i);
+			jaDictionaryAdd(d, key, &visits[i], 0);
+		}
+
+		// One at a time
+		memset(visits, 0, sizeof(size_t) * 5000);
+		state.start = d;
+
+		while ((item = jaDictionaryIterateNext(&state)) != NULL)
+		{
+			assert_true((state.actual == item));
+			*(size_t*)item->data += 1;
+		}
+
+		for (size_t i = 0; i < 5000; i++)
+			assert_int_equal(visits[i], 1);
+
+		// In batches, stopping at half to resume later
+		size_t n = 0;
+		size_t total = 0;
+
+		memset(visits, 0, sizeof(size_t) * 5000);
+		state.start = d;
+
+		while (total < 2500 && (n = jaDictionaryIterateBatch(&state, batch, 7)) != 0)
+		{
+			for (size_t i = 0; i < n; i++)
+				*(size_t*)batch[i]->data += 1;
+
+			total += n;
+		}
+
+		while ((n = jaDictionaryIterateBatch(&state, batch, 7)) != 0)
+		{
+			for (size_t i = 0; i < n; i++)
+				*(size_t*)batch[i]->data += 1;
+
+			total += n;
+		}
+
+		assert_int_equal(total, 5000);
+
+		for (size_t i = 0; i < 5000; i++)
+			assert_int_equal(visits[i], 1);
+
+		jaDictionaryDelete(d);
+	}
+
+	free(visits);
+}
+
+
+/*-----------------------------
+
+ DictionaryTest11_Thresholds()
+-----------------------------*/
+extern void DictionaryTest11_Thresholds(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	enum jaDictionaryFlags flags[] = {JA_DICTIONARY_DEFAULT, JA_DICTIONARY_OPEN_ADDRESSING, JA_DICTIONARY_ARENA,
+	                                  JA_DICTIONARY_SHARDED};
+	char key[32];
+
+	for (size_t f = 0; f < (sizeof(flags) / sizeof(enum jaDictionaryFlags)); f++)
+	{
+		struct jaDictionary* d = jaDictionaryCreateEx(NULL, flags[f]);
+
+		assert_int_equal(jaDictionarySetThresholds(d, 5, 0), 1);   // Grow too low
+		assert_int_equal(jaDictionarySetThresholds(d, 100, 0), 1); // Too high
+		assert_int_equal(jaDictionarySetThresholds(d, 60, 60), 1); // Without a band
+		assert_int_equal(jaDictionarySetThresholds(d, 60, 20), 0);
+
+		// Growing and shrinking, the table walks trough many levels
+		for (size_t round = 0; round < 2; round++)
+		{
+			for (size_t i = 0; i < 40000; i++)
+			{
+				snprintf(key, 32, "threshold%zu", i);
+				assert_true((jaDictionaryAdd(d, key, NULL, 0) != NULL));
+			}
+
+			// Removals and additions around the same size
+			for (size_t i = 0; i < 1000; i++)
+			{
+				snprintf(key, 32, "threshold%zu", i);
+				assert_int_equal(jaDictionaryRemoveN(d, key, strlen(key)), 0);
+				assert_true((jaDictionaryAdd(d, key, NULL, 0) != NULL));
+			}
+
+			for (size_t i = 0; i < 40000; i++)
+			{
+				snprintf(key, 32, "threshold%zu", i);
+				assert_true((jaDictionaryGet(d, key) != NULL));
+				assert_int_equal(jaDictionaryRemoveN(d, key, strlen(key)), 0);
+			}
+
+			assert_true((jaDictionaryGet(d, "threshold0") == NULL));
+
+			// Second round without shrinks
+			assert_int_equal(jaDictionarySetThresholds(d, 90, 0), 0);
+		}
+
+		jaDictionaryDelete(d);
+	}
+}
+
+
+/*-----------------------------
+
+ DictionaryTest12_Frozen()
+-----------------------------*/
+extern void DictionaryTest12_Frozen(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	struct jaDictionary* d = jaDictionaryCreate(NULL);
+	struct jaFrozenDictionary* frozen = NULL;
+	struct jaFrozenDictionary* loaded = NULL;
+	const void* blob = NULL;
+	uint64_t* blob_copy = NULL;
+	size_t blob_size = 0;
+	char key[32];
+
+	// Empty
+	assert_true(((frozen = jaDictionaryFreeze(d, 0)) != NULL));
+	assert_true((jaFrozenDictionaryGet(frozen, "Nothing") == NULL));
+	jaFrozenDictionaryDelete(frozen);
+
+	for (size_t i = 0; i < 20000; i++)
+	{
+		snprintf(key, 32, "frozen%zu", i);
+		jaDictionaryAdd(d, key, &i, sizeof(size_t));
+	}
+
+	jaDictionaryAdd(d, "frozen7", NULL, 0); // Duplicated, one is dropped
+	jaDictionaryAddN(d, "bin\0ary", 7, NULL, 0);
+
+	assert_true(((frozen = jaDictionaryFreeze(d, sizeof(size_t))) != NULL));
+	jaDictionaryDelete(d); // Frozen one is independent
+
+	// Flat blob, loaded back from a copy
+	blob = jaFrozenDictionaryBlob(frozen, &blob_size);
+	assert_true((blob != NULL && blob_size != 0));
+
+	blob_copy = malloc(blob_size + 8);
+	assert_true((blob_copy != NULL));
+	memcpy(blob_copy, blob, blob_size);
+
+	assert_true((jaFrozenDictionaryLoad(blob_copy, blob_size - 1) == NULL)); // Truncated
+	assert_true(((loaded = jaFrozenDictionaryLoad(blob_copy, blob_size)) != NULL));
+
+	for (size_t i = 0; i < 20000; i++)
+	{
+		const size_t* value = NULL;
+		size_t offset = 0;
+		snprintf(key, 32, "frozen%zu", i);
+
+		// Same data, at the same place of both blobs
+		assert_true(((value = jaFrozenDictionaryGet(frozen, key)) != NULL));
+		offset = (size_t)((const uint8_t*)value - (const uint8_t*)blob);
+		assert_true((jaFrozenDictionaryGet(loaded, key) == (const uint8_t*)blob_copy + offset));
+
+		if (i != 7) // Either of both
+			assert_int_equal(*value, i);
+
+		snprintf(key, 32, "missing%zu", i);
+		assert_true((jaFrozenDictionaryGet(loaded, key) == NULL));
+	}
+
+	assert_true((jaFrozenDictionaryGetN(loaded, "bin\0ary", 7) != NULL));
+	assert_true((jaFrozenDictionaryGetN(loaded, "bin", 3) == NULL));
+
+	jaFrozenDictionaryDelete(loaded);
+	jaFrozenDictionaryDelete(frozen);
+
+	// Corrupted
+	((char*)blob_copy)[0] = 'X';
+	assert_true((jaFrozenDictionaryLoad(blob_copy, blob_size) == NULL));
+
+	free(blob_copy);
+}
+
+
+/*-----------------------------
+
+ DictionaryTest13_Stats()
+-----------------------------*/
+extern void DictionaryTest13_Stats(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	enum jaDictionaryFlags flags[] = {JA_DICTIONARY_DEFAULT, JA_DICTIONARY_STATS,
+	                                  JA_DICTIONARY_STATS | JA_DICTIONARY_OPEN_ADDRESSING,
+	                                  JA_DICTIONARY_STATS | JA_DICTIONARY_CONCURRENT,
+	                                  JA_DICTIONARY_STATS | JA_DICTIONARY_SHARDED};
+
+	struct jaDictionaryStats stats;
+	char key[32];
+
+	for (size_t f = 0; f < (sizeof(flags) / sizeof(enum jaDictionaryFlags)); f++)
+	{
+		struct jaDictionary* d = jaDictionaryCreateEx(NULL, flags[f]);
+		size_t histogram_sum = 0;
+
+		for (size_t i = 0; i < 3000; i++)
+		{
+			snprintf(key, 32, "stats%zu", i);
+			jaDictionaryAdd(d, key, NULL, 0);
+		}
+
+		for (size_t i = 0; i < 1000; i++)
+		{
+			snprintf(key, 32, "stats%zu", i);
+			assert_true((jaDictionaryGet(d, key) != NULL));
+		}
+
+		assert_int_equal(jaDictionaryGetStats(d, &stats), 0);
+		assert_int_equal(stats.items_no, 3000);
+		assert_true((stats.load > 0 && stats.load <= 80));
+
+		for (size_t i = 0; i < JA_DICTIONARY_HISTOGRAM_LEN; i++)
+			histogram_sum += stats.histogram[i];
+
+		// Items by distance, or addresses by overflow buckets
+		if (flags[f] & (JA_DICTIONARY_OPEN_ADDRESSING | JA_DICTIONARY_CONCURRENT))
+			assert_int_equal(histogram_sum, stats.items_no);
+		else
+			assert_int_equal(histogram_sum, stats.buckets_no);
+
+		if (flags[f] & JA_DICTIONARY_STATS)
+		{
+			assert_int_equal(stats.lookups_no, 1000);
+			assert_true((stats.probes_no >= stats.lookups_no));
+			assert_true((stats.resizes_no > 0 && stats.resizes_ns >= stats.resize_max_ns));
+		}
+		else
+			assert_true((stats.lookups_no == 0 && stats.probes_no == 0 && stats.resizes_no == 0));
+
+		jaDictionaryDelete(d);
+	}
+}
+
+
+/*-----------------------------
+
+ DictionaryTest14_Seeded()
+-----------------------------*/
+static uint64_t sConstantHash(const char* key, size_t size)
+{
+	(void)key;
+	(void)size;
+	return 0;
+}
+
+extern void DictionaryTest14_Seeded(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	enum jaDictionaryFlags flags[] = {JA_DICTIONARY_SEEDED, JA_DICTIONARY_SEEDED | JA_DICTIONARY_OPEN_ADDRESSING,
+	                                  JA_DICTIONARY_SEEDED | JA_DICTIONARY_CONCURRENT,
+	                                  JA_DICTIONARY_SEEDED | JA_DICTIONARY_SHARDED};
+
+	struct jaDictionaryItem* item[2];
+	char key[32];
+
+	for (size_t f = 0; f < (sizeof(flags) / sizeof(enum jaDictionaryFlags)); f++)
+	{
+		// The hash function is ignored, otherwise every key collides
+		struct jaDictionary* d = jaDictionaryCreateEx(sConstantHash, flags[f]);
+		struct jaDictionary* other = jaDictionaryCreateEx(NULL, flags[f]);
+
+		for (size_t i = 0; i < 2000; i++)
+		{
+			snprintf(key, 32, "seeded%zu", i);
+			assert_true((jaDictionaryAdd(d, key, NULL, 0) != NULL));
+		}
+
+		for (size_t i = 0; i < 2000; i += 2)
+		{
+			snprintf(key, 32, "seeded%zu", i);
+			jaDictionaryRemove(jaDictionaryGet(d, key));
+		}
+
+		for (size_t i = 0; i < 2000; i++)
+		{
+			snprintf(key, 32, "seeded%zu", i);
+			assert_true(((jaDictionaryGet(d, key) != NULL) == (i % 2 == 1)));
+		}
+
+		// Same key, different hashes
+		item[0] = jaDictionaryGet(d, "seeded1");
+		item[1] = jaDictionaryAdd(other, "seeded1", NULL, 0);
+
+		assert_true((item[0]->hash != 0 && item[0]->hash != jaDictionaryGet(d, "seeded3")->hash));
+		assert_true((item[0]->hash != item[1]->hash));
+
+		jaDictionaryDelete(other);
+		jaDictionaryDelete(d);
+	}
+}
+
+
+/*-----------------------------
+
+ DictionaryTest15_Allocator()
+-----------------------------*/
+struct Counter
+{
+	size_t live;
+	size_t calls;
+};
+
+static void* sCountAllocate(size_t size, void* context)
+{
+	((struct Counter*)context)->live += 1;
+	((struct Counter*)context)->calls += 1;
+	return malloc(size);
+}
+
+static void* sCountReallocate(void* ptr, size_t size, void* context)
+{
+	((struct Counter*)context)->live += (ptr == NULL) ? 1 : 0;
+	((struct Counter*)context)->calls += 1;
+	return realloc(ptr, size);
+}
+
+static void sCountDeallocate(void* ptr, void* context)
+{
+	((struct Counter*)context)->live -= 1;
+	free(ptr);
+}
+
+extern void DictionaryTest15_Allocator(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	enum jaDictionaryFlags flags[] = {JA_DICTIONARY_DEFAULT, JA_DICTIONARY_OPEN_ADDRESSING, JA_DICTIONARY_ARENA,
+	                                  JA_DICTIONARY_CONCURRENT, JA_DICTIONARY_SHARDED | JA_DICTIONARY_ARENA};
+
+	struct Counter counter = {0};
+	struct jaAllocator allocator = {sCountAllocate, sCountReallocate, sCountDeallocate, &counter};
+	struct jaFrozenDictionary* frozen = NULL;
+	struct jaDictionaryItem* item = NULL;
+	char key[32];
+
+	for (size_t f = 0; f < (sizeof(flags) / sizeof(enum jaDictionaryFlags)); f++)
+	{
+		struct jaDictionary* d = jaDictionaryCreateWith(NULL, flags[f], 4, &allocator);
+		assert_true((d != NULL && counter.live != 0));
+
+		for (size_t i = 0; i < 5000; i++)
+		{
+			snprintf(key, 32, "allocated%zu", i);
+			assert_true((jaDictionaryAdd(d, key, NULL, sizeof(size_t)) != NULL));
+		}
+
+		for (size_t i = 0; i < 5000; i += 3)
+		{
+			snprintf(key, 32, "allocated%zu", i);
+			assert_int_equal(jaDictionaryRemoveN(d, key, strlen(key)), 0);
+		}
+
+		// Detached items are ours, to give back to the same allocator
+		if ((flags[f] & JA_DICTIONARY_ARENA) == 0)
+		{
+			item = jaDictionaryGet(d, "allocated1");
+			assert_int_equal(jaDictionaryDetach(item), 0);
+			allocator.deallocate(item, allocator.context);
+		}
+
+		assert_true(((frozen = jaDictionaryFreeze(d, 0)) != NULL));
+		assert_true((jaFrozenDictionaryGet(frozen, "allocated2") != NULL));
+
+		jaFrozenDictionaryDelete(frozen);
+		jaDictionaryDelete(d);
+
+		assert_int_equal(counter.live, 0);
+	}
+
+	assert_true((counter.calls != 0));
+}
@@ -245,3 +245,130 @@ void ListTest3_BeforeAfterAddition(void** cmocka_state)
 	// Bye!
 	jaListClean(&list);
 }
+
+
+/*-----------------------------
+
+ ListTest4_Intrusive()
+-----------------------------*/
+struct Agent
+{
+	int number;
+	struct jaListNode node;
+};
+
+void ListTest4_Intrusive(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	struct Agent agent[5] = {{1, {0}}, {2, {0}}, {3, {0}}, {4, {0}}, {5, {0}}};
+	struct jaNodeList list = {0};
+	struct jaNodeListState state = {0};
+	struct jaListNode* node = NULL;
+	int expected[] = {1, 2, 3, 4, 5};
+	int i = 0;
+
+	// 2, 4, then 1 and 5 at the ends, and 3 between
+	assert_int_equal(jaNodeListAdd(&list, &agent[1].node), 0);
+	assert_int_equal(jaNodeListAdd(&list, &agent[3].node), 0);
+	assert_int_equal(jaNodeListAddBefore(&agent[1].node, &agent[0].node), 0);
+	assert_int_equal(jaNodeListAddAfter(&agent[3].node, &agent[4].node), 0);
+	assert_int_equal(jaNodeListAddAfter(&agent[1].node, &agent[2].node), 0);
+
+	assert_int_equal(jaNodeListAdd(&list, &agent[2].node), 1); // Already there
+	assert_int_equal(list.nodes_no, 5);
+
+	state.start = list.first;
+	while ((node = jaNodeListIterate(&state)) != NULL)
+		assert_int_equal(JA_LIST_NODE_OWNER(node, struct Agent, node)->number, expected[i++]);
+
+	assert_int_equal(i, 5);
+
+	// Backwards, removing the even ones
+	state.start = list.last;
+	state.reverse = true;
+
+	while ((node = jaNodeListIterate(&state)) != NULL)
+	{
+		if (JA_LIST_NODE_OWNER(node, struct Agent, node)->number % 2 == 0)
+			assert_int_equal(jaNodeListRemove(node), 0);
+	}
+
+	assert_int_equal(jaNodeListRemove(&agent[1].node), 1); // Not in a list
+	assert_int_equal(list.nodes_no, 3);
+
+	// As a queue
+	int expected_queue[] = {1, 3, 5, 2};
+	assert_int_equal(jaNodeListAdd(&list, &agent[1].node), 0);
+
+	for (i = 0; (node = jaNodeListPop(&list)) != NULL; i++)
+		assert_int_equal(JA_LIST_NODE_OWNER(node, struct Agent, node)->number, expected_queue[i]);
+
+	assert_int_equal(i, 4);
+	assert_true((list.first == NULL && list.last == NULL && list.nodes_no == 0));
+}
+
+
+/*-----------------------------
+
+ ListTest5_Pooled()
+-----------------------------*/
+static size_t s_deleted_no = 0;
+
+static void sCountDeleted(struct jaListItem* item)
+{
+	(void)item;
+	s_deleted_no += 1;
+}
+
+void ListTest5_Pooled(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	struct jaList list = {0};
+	struct jaListItem* item = NULL;
+	struct jaListItem* removed = NULL;
+	struct jaListState state = {0};
+	size_t i = 0;
+
+	list.flags = JA_LIST_POOLED;
+
+	for (size_t frame = 0; frame < 3; frame++)
+	{
+		for (i = 0; i < 100000; i++)
+		{
+			assert_true(((item = jaListAdd(&list, &i, sizeof(size_t))) != NULL));
+
+			if (i % 10 == 0)
+				item->callback_delete = sCountDeleted;
+		}
+
+		// Removed items are recycled
+		removed = list.last;
+		jaListRemove(removed);
+		assert_true((jaListAdd(&list, &i, sizeof(size_t)) == removed));
+		assert_int_equal(*(size_t*)removed->data, 100000);
+
+		// Bigger ones aren't
+		assert_true((jaListAddAfter(list.first, "Moonraker", sizeof("Moonraker")) != NULL));
+		jaListRemove(list.first->next);
+		assert_true((jaListAdd(&list, NULL, 1024) != NULL));
+
+		state.start = list.first;
+		for (i = 0; (item = jaListIterate(&state)) != NULL && i < 100000; i++)
+			assert_int_equal(*(size_t*)item->data, (i < 99999) ? i : 100000);
+
+		assert_int_equal(list.items_no, 100001);
+
+		// Memory kept for the next frame
+		s_deleted_no = 0;
+		jaListClear(&list);
+
+		assert_int_equal(s_deleted_no, 10000);
+		assert_true((list.first == NULL && list.last == NULL && list.items_no == 0 && list.pool.first != NULL));
+	}
+
+	jaListAdd(&list, NULL, 0);
+	jaListClean(&list);
+	assert_true((list.first == NULL && list.pool.first == NULL));
+}
@@ -189,3 +189,150 @@ void StringEncodeTest1_KuhnOneShot(void** cmocka_state)
 	fclose(fp_out);
 	fclose(fp_in);
 }
+
+
+void StringTest2_Views(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	const char* text = "  cat, dog,bunny ,,parrot\t\n";
+	struct jaBufferView input = jaStringTrim(jaBufferViewString(text));
+	struct jaBufferView field;
+	struct jaBuffer copy = {0};
+	size_t units = 0;
+
+	assert_true((input.data == text + 2 && input.size == 23));
+
+	// Every field points into the text
+	const char* expected[] = {"cat", "dog", "bunny", "", "parrot"};
+
+	for (size_t i = 0; input.size != 0; i++)
+	{
+		field = jaStringTrim(jaStringSplit(&input, ','));
+
+		assert_true((i < 5));
+		assert_true((jaBufferViewEqual(field, jaBufferViewString(expected[i])) == 1));
+		assert_true((field.size == 0 || ((const char*)field.data >= text && (const char*)field.data < text + 27)));
+	}
+
+	// Slices clamped
+	field = jaBufferViewSlice(jaBufferViewString(text), 20, 100);
+	assert_true((field.size == 7 && field.data == text + 20));
+	field = jaBufferViewSlice(jaBufferViewString(text), 100, 1);
+	assert_true((field.size == 0));
+
+	assert_true((jaBufferViewFind(jaBufferViewString(text), 'd') == 7));
+	assert_true((jaBufferViewFind(jaBufferViewString(text), 'z') == 27));
+
+	// Validation without a NULL terminator
+	assert_true((jaStringValidateView(jaBufferViewOf("オウム!", 10), JA_UTF8, &units) == 0));
+	assert_true((units == 4));
+	assert_true((jaStringValidateView(jaBufferViewOf("オウム!", 8), JA_UTF8, &units) != 0)); // Cut unit
+	assert_true((units == 2));
+	assert_true((jaStringValidateView(jaBufferViewOf("オウム!", 10), JA_ASCII, &units) != 0));
+
+	// Copies only when asked
+	assert_true((jaBufferCopyView(&copy, jaBufferViewOf(text + 2, 3)) == 0));
+	assert_true((memcmp(copy.data, "cat", 3) == 0 && copy.data != text + 2));
+	assert_true((copy.length == 3));
+	assert_true((jaBufferCopyView(&copy, jaBufferViewOf(text, 0)) == 0 && copy.length == 0));
+	jaBufferClean(&copy);
+}
+
+
+/*-----------------------------
+
+ StringTest3_Vectorized()
+-----------------------------*/
+static int sReferenceUTF8(const uint8_t* string, size_t n, bool stop_at_null, size_t* out_bytes, size_t* out_units)
+{
+	// A unit at a time, as vectorized validation should behave
+	size_t unit_len = 0;
+	*out_bytes = 0;
+	*out_units = 0;
+
+	while (*out_bytes < n)
+	{
+		if (jaUnitValidateUTF8(string + *out_bytes, n - *out_bytes, &unit_len, NULL) != 0)
+			return 1;
+
+		*out_units += 1;
+		*out_bytes += unit_len;
+
+		if (stop_at_null == true && string[*out_bytes - unit_len] == 0x00)
+			return 0;
+	}
+
+	return (stop_at_null == true) ? 1 : 0;
+}
+
+static size_t sEncode(uint32_t code, size_t len, uint8_t* out)
+{
+	// Overlong ones if 'len' is more than required
+	if (len == 1)
+	{
+		out[0] = (uint8_t)code;
+		return 1;
+	}
+
+	for (size_t i = len - 1; i > 0; i--, code >>= 6)
+		out[i] = (uint8_t)(0x80 | (code & 0x3F));
+
+	out[0] = (uint8_t)((0xFF << (8 - len)) | code);
+	return len;
+}
+
+void StringTest3_Vectorized(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	uint8_t string[1024];
+	uint64_t state = 1;
+
+	for (int round = 0; round < 20000; round++)
+	{
+		size_t n = 0;
+		size_t limit = (size_t)(round % 1000) + 1;
+		uint32_t r = 0;
+
+		// Mostly valid, with long ASCII runs crossing blocks
+		while (n + 4 < limit)
+		{
+			state = state * 6364136223846793005 + 1442695040888963407;
+			r = (uint32_t)(state >> 33);
+
+			switch (r % 64)
+			{
+			case 0: string[n++] = (uint8_t)(r >> 8); break;                  // Anything
+			case 1: string[n++] = (r & 0x100) ? 0x00 : 0x80; break;           // NULL, lone tail
+			case 2: n += sEncode((r >> 8) % 0x800, 3, string + n); break;      // Overlong
+			case 3: n += sEncode(0xD800 + (r >> 8) % 0x800, 3, string + n); break; // Surrogate
+			case 4: n += sEncode(0x110000 + (r >> 8) % 0x1000, 4, string + n); break; // Too large
+			case 5: n += sEncode(0x80 + (r >> 8) % 0x780, 2, string + n) - 1; break; // Cut
+			case 6: case 7: case 8: n += sEncode(0x80 + (r >> 8) % 0x780, 2, string + n); break;
+			case 9: case 10: case 11: n += sEncode(0xE000 + (r >> 8) % 0x2000, 3, string + n); break;
+			case 12: case 13: case 14: n += sEncode(0x800 + (r >> 8) % 0xD000, 3, string + n); break;
+			case 15: case 16: n += sEncode(0x10000 + (r >> 8) % 0x100000, 4, string + n); break;
+			default: string[n++] = (uint8_t)(0x20 + (r >> 8) % 95);
+			}
+
+			// Often valid for a while
+			if (round % 3 != 0 && r % 64 < 6)
+				n -= (n > 0) ? 1 : 0;
+		}
+
+		size_t bytes = 0;
+		size_t units = 0;
+		size_t expected_bytes = 0;
+		size_t expected_units = 0;
+
+		assert_int_equal(jaStringValidateUTF8(string, n, &bytes, &units),
+		                 sReferenceUTF8(string, n, true, &expected_bytes, &expected_units));
+		assert_int_equal(bytes, expected_bytes);
+		assert_int_equal(units, expected_units);
+
+		assert_int_equal(jaStringValidateView(jaBufferViewOf(string, n), JA_UTF8, &units),
+		                 sReferenceUTF8(string, n, false, &expected_bytes, &expected_units));
+		assert_int_equal(units, expected_units);
+	}
+}
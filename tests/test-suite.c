@@ -20,19 +20,45 @@
 #include <cmocka.h>
 
 
+extern void BufferTest1_Append(void** cmocka_state);
+extern void BufferTest2_Aligned(void** cmocka_state);
+extern void BufferTest3_Allocator(void** cmocka_state);
+
 extern void ListTest1_Iteration(void** cmocka_state);
 extern void ListTest2_RemovalAtIteration(void** cmocka_state);
 extern void ListTest3_BeforeAfterAddition(void** cmocka_state);
+extern void ListTest4_Intrusive(void** cmocka_state);
+extern void ListTest5_Pooled(void** cmocka_state);
 
 extern void DictionaryTest1_FNV1Hash(void** cmocka_state);
 extern void DictionaryTest2_SimpleUsage(void** cmocka_state);
+extern void DictionaryTest3_OpenAddressing(void** cmocka_state);
+extern void DictionaryTest4_LengthAware(void** cmocka_state);
+extern void DictionaryTest5_WyHash(void** cmocka_state);
+extern void DictionaryTest6_Arena(void** cmocka_state);
+extern void DictionaryTest7_Reserve(void** cmocka_state);
+extern void DictionaryTest8_Concurrent(void** cmocka_state);
+extern void DictionaryTest9_Sharded(void** cmocka_state);
+extern void DictionaryTest10_Cursor(void** cmocka_state);
+extern void DictionaryTest11_Thresholds(void** cmocka_state);
+extern void DictionaryTest12_Frozen(void** cmocka_state);
+extern void DictionaryTest13_Stats(void** cmocka_state);
+extern void DictionaryTest14_Seeded(void** cmocka_state);
+extern void DictionaryTest15_Allocator(void** cmocka_state);
 
 extern void ImageTest1_Sgi(void** cmocka_state);
 
+extern void TreeTest1_Flat(void** cmocka_state);
+extern void TreeTest2_Orders(void** cmocka_state);
+extern void TreeTest3_Parallel(void** cmocka_state);
+extern void TreeTest4_Pooled(void** cmocka_state);
+
 extern void StringEncodeTest1_KuhnBigBuffer(void** cmocka_state);
 extern void StringEncodeTest1_KuhnLittleBuffer(void** cmocka_state);
 extern void StringEncodeTest1_KuhnOneShot(void** cmocka_state);
 extern void StringEncodeTest1_Coherency(void** cmocka_state);
+extern void StringTest2_Views(void** cmocka_state);
+extern void StringTest3_Vectorized(void** cmocka_state);
 
 extern void ConfigTest1(void** cmocka_state);
 
@@ -42,19 +68,45 @@ int main()
 
 	mkdir("./tests/out/", 0777); // Deprecated on Windows...
 
-	struct CMUnitTest tests[] = {cmocka_unit_test(ListTest1_Iteration),
+	struct CMUnitTest tests[] = {cmocka_unit_test(BufferTest1_Append),
+	                             cmocka_unit_test(BufferTest2_Aligned),
+	                             cmocka_unit_test(BufferTest3_Allocator),
+
+	                             cmocka_unit_test(ListTest1_Iteration),
 	                             cmocka_unit_test(ListTest2_RemovalAtIteration),
 	                             cmocka_unit_test(ListTest3_BeforeAfterAddition),
+	                             cmocka_unit_test(ListTest4_Intrusive),
+	                             cmocka_unit_test(ListTest5_Pooled),
 
 	                             cmocka_unit_test(DictionaryTest1_FNV1Hash),
 	                             cmocka_unit_test(DictionaryTest2_SimpleUsage),
+	                             cmocka_unit_test(DictionaryTest3_OpenAddressing),
+	                             cmocka_unit_test(DictionaryTest4_LengthAware),
+	                             cmocka_unit_test(DictionaryTest5_WyHash),
+	                             cmocka_unit_test(DictionaryTest6_Arena),
+	                             cmocka_unit_test(DictionaryTest7_Reserve),
+	                             cmocka_unit_test(DictionaryTest8_Concurrent),
+	                             cmocka_unit_test(DictionaryTest9_Sharded),
+	                             cmocka_unit_test(DictionaryTest10_Cursor),
+	                             cmocka_unit_test(DictionaryTest11_Thresholds),
+	                             cmocka_unit_test(DictionaryTest12_Frozen),
+	                             cmocka_unit_test(DictionaryTest13_Stats),
+	                             cmocka_unit_test(DictionaryTest14_Seeded),
+	                             cmocka_unit_test(DictionaryTest15_Allocator),
 
 	                             cmocka_unit_test(ImageTest1_Sgi),
 
+	                             cmocka_unit_test(TreeTest1_Flat),
+	                             cmocka_unit_test(TreeTest2_Orders),
+	                             cmocka_unit_test(TreeTest3_Parallel),
+	                             cmocka_unit_test(TreeTest4_Pooled),
+
 	                             cmocka_unit_test(StringEncodeTest1_KuhnBigBuffer),
 	                             cmocka_unit_test(StringEncodeTest1_KuhnLittleBuffer),
 	                             cmocka_unit_test(StringEncodeTest1_KuhnOneShot),
 	                             cmocka_unit_test(StringEncodeTest1_Coherency),
+	                             cmocka_unit_test(StringTest2_Views),
+	                             cmocka_unit_test(StringTest3_Vectorized),
 
 	                             cmocka_unit_test(ConfigTest1)};
 
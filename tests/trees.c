@@ -0,0 +1,410 @@
+/*-----------------------------
+
+ [trees.c]
+ - Alexander Brandt 2020
+-----------------------------*/
+
+#include <math.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <cmocka.h>
+
+#include "japan-tree.h"
+
+
+/*-----------------------------
+
+ TreeTest1_Flat()
+-----------------------------*/
+static void sCheckOrder(const struct jaFlatTree* tree, const int* expected, size_t expected_no)
+{
+	size_t n = 0;
+
+	for (uint32_t i = jaFlatTreeNext(tree, JA_FLAT_TREE_NONE); i != JA_FLAT_TREE_NONE; i = jaFlatTreeNext(tree, i))
+	{
+		assert_true((n < expected_no));
+		assert_int_equal(*(int*)jaFlatTreeData(tree, i), expected[n++]);
+
+		// Parents first
+		if (tree->ordered == true && jaFlatTreeNode(tree, i)->parent != JA_FLAT_TREE_NONE)
+			assert_true((jaFlatTreeNode(tree, i)->parent < i));
+	}
+
+	assert_int_equal(n, expected_no);
+}
+
+static uint32_t sAdd(struct jaFlatTree* tree, uint32_t parent, int value)
+{
+	return jaFlatTreeAdd(tree, parent, &value);
+}
+
+void TreeTest1_Flat(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	struct jaFlatTree tree = {0};
+	uint32_t node[10];
+	int value = 0;
+
+	tree.data_size = sizeof(int);
+
+	// 0 -> (1 -> (2, 3), 4), and 5 as another root
+	node[0] = sAdd(&tree, JA_FLAT_TREE_NONE, 0);
+	node[1] = sAdd(&tree, node[0], 1);
+	node[2] = sAdd(&tree, node[1], 2);
+	node[3] = sAdd(&tree, node[1], 3);
+	node[4] = sAdd(&tree, node[0], 4);
+	node[5] = sAdd(&tree, JA_FLAT_TREE_NONE, 5);
+
+	assert_true((tree.ordered == true && tree.nodes_no == 6));
+	sCheckOrder(&tree, (int[]){0, 1, 2, 3, 4, 5}, 6);
+
+	// Out of order, 6 under 1 and 7 under 6
+	node[6] = sAdd(&tree, node[1], 6);
+	node[7] = sAdd(&tree, node[6], 7);
+
+	assert_true((tree.ordered == false));
+	sCheckOrder(&tree, (int[]){0, 1, 2, 3, 6, 7, 4, 5}, 8);
+
+	// Removal of a subtree, and of a root
+	assert_int_equal(jaFlatTreeRemove(&tree, node[1]), 0);
+	assert_int_equal(jaFlatTreeRemove(&tree, node[7]), 1); // Already, with its parent
+	assert_true((jaFlatTreeAdd(&tree, node[2], &value) == JA_FLAT_TREE_NONE));
+	sCheckOrder(&tree, (int[]){0, 4, 5}, 3);
+
+	node[8] = sAdd(&tree, node[4], 8);
+	assert_int_equal(jaFlatTreeRemove(&tree, node[0]), 0);
+	node[9] = sAdd(&tree, node[5], 9);
+	sCheckOrder(&tree, (int[]){5, 9}, 2);
+
+	// Back in order, indices changed
+	assert_int_equal(jaFlatTreeCompact(&tree), 0);
+	assert_true((tree.ordered == true && tree.nodes_no == 2 && tree.first == 0 && tree.last == 0));
+	sCheckOrder(&tree, (int[]){5, 9}, 2);
+
+	assert_true((sAdd(&tree, 1, 10) == 2));
+	assert_true((sAdd(&tree, JA_FLAT_TREE_NONE, 11) == 3));
+	assert_true((tree.ordered == true && tree.last == 3));
+	sCheckOrder(&tree, (int[]){5, 9, 10, 11}, 4);
+
+	// Many
+	jaFlatTreeClean(&tree);
+	uint64_t state = 1;
+	int sum = 0;
+
+	for (value = 0; value < 100000; value++)
+	{
+		state = state * 6364136223846793005 + 1442695040888963407;
+		jaFlatTreeAdd(&tree, (value == 0) ? JA_FLAT_TREE_NONE : (uint32_t)((state >> 33) % (uint64_t)value), &value);
+	}
+
+	for (uint32_t i = 0; i < 100000; i += 7)
+		jaFlatTreeRemove(&tree, i);
+
+	for (uint32_t i = jaFlatTreeNext(&tree, JA_FLAT_TREE_NONE); i != JA_FLAT_TREE_NONE; i = jaFlatTreeNext(&tree, i))
+		sum += *(int*)jaFlatTreeData(&tree, i);
+
+	assert_int_equal(jaFlatTreeCompact(&tree), 0);
+
+	for (uint32_t i = 0; i < tree.nodes_no; i++)
+	{
+		sum -= *(int*)jaFlatTreeData(&tree, i);
+
+		if (tree.ordered == true && jaFlatTreeNode(&tree, i)->parent != JA_FLAT_TREE_NONE)
+			assert_true((jaFlatTreeNode(&tree, i)->parent < i));
+	}
+
+	assert_int_equal(sum, 0);
+	jaFlatTreeClean(&tree);
+}
+
+
+/*-----------------------------
+
+ TreeTest2_Orders()
+-----------------------------*/
+static void sCheckCursor(struct jaTree* start, enum jaTreeOrder order, const int* expected, const size_t* depth,
+                         size_t expected_no)
+{
+	struct jaTreeCursor cursor = {0};
+	struct jaTree* tree = NULL;
+	size_t n = 0;
+
+	cursor.start = start;
+	cursor.order = order;
+
+	while ((tree = jaTreeIterateNext(&cursor)) != NULL)
+	{
+		assert_true((n < expected_no));
+		assert_int_equal(*(int*)tree->data, expected[n]);
+		assert_int_equal(cursor.depth, depth[n]);
+		n++;
+	}
+
+	assert_int_equal(n, expected_no);
+	assert_null(jaTreeIterateNext(&cursor)); // Stays at the end
+}
+
+static struct jaTree* sCreate(struct jaTree* parent, int value)
+{
+	return jaTreeCreate(parent, &value, sizeof(int));
+}
+
+void TreeTest2_Orders(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	struct jaTreeState state = {0};
+	struct jaTreeCursor cursor = {0};
+	struct jaTree* node[7];
+	struct jaTree* tree = NULL;
+	size_t n = 0;
+
+	// 0 -> (1 -> (3, 4), 2 -> 5), with 6 as a brother of 0
+	node[0] = sCreate(NULL, 0);
+	node[1] = sCreate(node[0], 1);
+	node[2] = sCreate(node[0], 2);
+	node[3] = sCreate(node[1], 3);
+	node[4] = sCreate(node[1], 4);
+	node[5] = sCreate(node[2], 5);
+	node[6] = sCreate(NULL, 6);
+	node[0]->next = node[6];
+
+	sCheckCursor(node[0], JA_TREE_PRE_ORDER, (int[]){0, 1, 3, 4, 2, 5}, (size_t[]){0, 1, 2, 2, 1, 2}, 6);
+	sCheckCursor(node[0], JA_TREE_POST_ORDER, (int[]){3, 4, 1, 5, 2, 0}, (size_t[]){2, 2, 1, 2, 1, 0}, 6);
+	sCheckCursor(node[0], JA_TREE_BREADTH_FIRST, (int[]){0, 1, 2, 3, 4, 5}, (size_t[]){0, 1, 1, 2, 2, 2}, 6);
+
+	// Subtrees, not leaving them
+	sCheckCursor(node[1], JA_TREE_PRE_ORDER, (int[]){1, 3, 4}, (size_t[]){0, 1, 1}, 3);
+	sCheckCursor(node[1], JA_TREE_POST_ORDER, (int[]){3, 4, 1}, (size_t[]){1, 1, 0}, 3);
+	sCheckCursor(node[1], JA_TREE_BREADTH_FIRST, (int[]){1, 3, 4}, (size_t[]){0, 1, 1}, 3);
+	sCheckCursor(node[5], JA_TREE_POST_ORDER, (int[]){5}, (size_t[]){0}, 1);
+
+	// Iterate() without a buffer
+	state.start = node[0];
+
+	while ((tree = jaTreeIterate(&state, NULL)) != NULL)
+		n++;
+
+	assert_int_equal(n, 6);
+
+	node[0]->next = NULL;
+	jaTreeDelete(node[6]);
+	jaTreeDelete(node[0]);
+
+	// Way deeper than JA_TREE_STACK_DEPTH
+	node[0] = sCreate(NULL, 0);
+	tree = node[0];
+
+	for (int i = 1; i < 5000; i++)
+	{
+		tree = sCreate(tree, i);
+		sCreate(tree->parent, -i); // A brother
+	}
+
+	for (enum jaTreeOrder order = JA_TREE_PRE_ORDER; order <= JA_TREE_BREADTH_FIRST; order++)
+	{
+		int sum = 0;
+		size_t max_depth = 0;
+
+		memset(&cursor, 0, sizeof(struct jaTreeCursor));
+		cursor.start = node[0];
+		cursor.order = order;
+		n = 0;
+
+		while ((tree = jaTreeIterateNext(&cursor)) != NULL)
+		{
+			sum += *(int*)tree->data;
+			max_depth = (cursor.depth > max_depth) ? cursor.depth : max_depth;
+			n++;
+		}
+
+		assert_int_equal(n, 9999);
+		assert_int_equal(sum, 0);
+		assert_int_equal(max_depth, 4999);
+	}
+
+	jaTreeDelete(node[0]);
+}
+
+
+/*-----------------------------
+
+ TreeTest3_Parallel()
+-----------------------------*/
+struct Node
+{
+	size_t index;
+	int depth;    // Known
+	int computed; // By workers
+};
+
+static bool s_deleted[20000];
+
+static void sAccumulate(struct jaTree* tree, const void* parent_value, void* value, void* extra_data)
+{
+	(void)extra_data;
+
+	*(int*)value = *(const int*)parent_value + 1;
+	((struct Node*)tree->data)->computed = *(int*)value;
+}
+
+static void sMarkDeleted(struct jaTree* tree)
+{
+	s_deleted[((struct Node*)tree->data)->index] = true;
+}
+
+void TreeTest3_Parallel(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	struct jaTree* node[20000];
+	struct Node data = {0};
+	uint64_t state = 1;
+	int root_value = 10;
+
+	for (size_t workers_no = 1; workers_no <= 4; workers_no += 3)
+	{
+		// Random parents, plus a long branch
+		for (size_t i = 0; i < 20000; i++)
+		{
+			struct jaTree* parent = NULL;
+
+			state = state * 6364136223846793005 + 1442695040888963407;
+
+			if (i > 0)
+				parent = node[(i < 15000) ? (size_t)((state >> 33) % i) : i - 1];
+
+			data.index = i;
+			data.depth = (parent == NULL) ? 11 : ((struct Node*)parent->data)->depth + 1;
+
+			node[i] = jaTreeCreate(parent, &data, sizeof(struct Node));
+			node[i]->callback_delete = sMarkDeleted;
+			s_deleted[i] = false;
+		}
+
+		assert_int_equal(jaTreeIterateParallel(node[0], workers_no, sAccumulate, sizeof(int), &root_value, NULL), 0);
+
+		for (size_t i = 0; i < 20000; i++)
+			assert_int_equal(((struct Node*)node[i]->data)->computed, ((struct Node*)node[i]->data)->depth);
+
+		jaTreeDeleteParallel(node[0], workers_no);
+
+		for (size_t i = 0; i < 20000; i++)
+			assert_true(s_deleted[i]);
+	}
+}
+
+
+/*-----------------------------
+
+ TreeTest4_Pooled()
+-----------------------------*/
+struct Counter
+{
+	size_t live;
+	size_t calls;
+};
+
+static void* sCountAllocate(size_t size, void* context)
+{
+	((struct Counter*)context)->live += 1;
+	((struct Counter*)context)->calls += 1;
+	return malloc(size);
+}
+
+static void* sCountReallocate(void* ptr, size_t size, void* context)
+{
+	((struct Counter*)context)->live += (ptr == NULL) ? 1 : 0;
+	((struct Counter*)context)->calls += 1;
+	return realloc(ptr, size);
+}
+
+static void sCountDeallocate(void* ptr, void* context)
+{
+	((struct Counter*)context)->live -= 1;
+	free(ptr);
+}
+
+static size_t s_deleted_no;
+
+static void sCountDeleted(struct jaTree* tree)
+{
+	(void)tree;
+	s_deleted_no += 1;
+}
+
+void TreeTest4_Pooled(void** cmocka_state)
+{
+	(void)cmocka_state;
+
+	struct Counter counter = {0};
+	struct jaAllocator allocator = {sCountAllocate, sCountReallocate, sCountDeallocate, &counter};
+	enum jaTreePoolFlags flags[] = {JA_TREE_POOL_DEFAULT, JA_TREE_POOL_CALLBACKS};
+	struct jaTree* node[10000];
+	struct jaTree* other = NULL;
+	uint64_t state = 1;
+
+	for (size_t f = 0; f < 2; f++)
+	{
+		size_t calls = 0;
+		s_deleted_no = 0;
+		counter.calls = 0;
+
+		node[0] = jaTreeCreatePool(NULL, 0, &allocator, flags[f]);
+		assert_non_null(node[0]);
+
+		// Random parents, a callback in every node
+		for (size_t i = 1; i < 10000; i++)
+		{
+			state = state * 6364136223846793005 + 1442695040888963407;
+			node[i] = jaTreeCreateWith(node[(state >> 33) % i], &i, sizeof(size_t), NULL); // Allocator ignored
+			assert_non_null(node[i]);
+			assert_true((node[i]->parent != NULL));
+			node[i]->callback_delete = sCountDeleted;
+		}
+
+		assert_true((counter.calls < 20)); // Chunks, not nodes
+
+		// Nodes stay in their pool, and roots at the top
+		other = jaTreeCreate(NULL, NULL, 0);
+		assert_int_equal(jaTreeAttach(other, node[0]), 1);
+		assert_int_equal(jaTreeAttach(node[0], other), 1);
+		jaTreeDelete(other);
+
+		// A subtree returns to the pool, and is taken again
+		assert_int_equal(jaTreeDetach(node[1]), 0);
+		assert_int_equal(jaTreeAttach(node[1], node[2]), 0);
+		assert_int_equal(jaTreeDetach(node[1]), 0);
+
+		jaTreeDelete(node[1]);
+		assert_true((s_deleted_no > 0));
+
+		calls = counter.calls;
+		s_deleted_no = 0;
+
+		for (size_t i = 0; i < 100; i++)
+		{
+			other = jaTreeCreate(node[0], &i, sizeof(size_t));
+			assert_int_equal(*(size_t*)other->data, i);
+		}
+
+		assert_int_equal(counter.calls, calls);
+
+		// All at once
+		jaTreeDelete(node[0]);
+		assert_int_equal(counter.live, 0);
+
+		if (flags[f] & JA_TREE_POOL_CALLBACKS)
+			assert_true((s_deleted_no > 0));
+		else
+			assert_int_equal(s_deleted_no, 0);
+	}
+}